@@ -5,6 +5,7 @@
 #include <map>
 #include <vector>
 
+#include <util/small_map.h>
 #include <sdp/types.h>
 
 namespace sippy::sdp::attributes {
@@ -46,7 +47,7 @@ struct _base_attribute_holder {
     [[nodiscard]] virtual const char* name() const = 0;
     [[nodiscard]] virtual uint32_t flags() const = 0;
 
-    virtual std::istream& operator>>(std::istream& is) = 0;
+    virtual serialization::span_reader& operator>>(serialization::span_reader& reader) = 0;
     virtual std::ostream& operator<<(std::ostream& os) const = 0;
 };
 
@@ -59,9 +60,9 @@ struct _attribute_holder final : _base_attribute_holder {
         return meta::_attribute_detail<T>::flags();
     }
 
-    std::istream& operator>>(std::istream& is) override {
-        is >> value;
-        return is;
+    serialization::span_reader& operator>>(serialization::span_reader& reader) override {
+        reader >> value;
+        return reader;
     }
     std::ostream& operator<<(std::ostream& os) const override {
         os << value;
@@ -118,14 +119,13 @@ public:
         using pointer           = value_type*;
         using reference         = value_type&;
 
-        const_iterator(attr_map::const_iterator map_it, attr_list::const_iterator lst_it)
+        // walks the lists of [map_it, map_end), skipping empty ones
+        const_iterator(attr_map::const_iterator map_it, attr_map::const_iterator map_end)
             : m_map_it(map_it)
-            , m_lst_it(lst_it)
-        {}
-        explicit const_iterator(attr_map::const_iterator map_it)
-            : m_map_it(map_it)
-            , m_lst_it(map_it->second.cbegin())
-        {}
+            , m_map_end(map_end)
+            , m_lst_it() {
+            skip_empty_lists();
+        }
 
         reference operator*() const { return m_lst_it->operator*(); }
         pointer operator->() { return m_lst_it->operator->(); }
@@ -134,7 +134,7 @@ public:
             ++m_lst_it;
             if (m_lst_it == m_map_it->second.cend()) {
                 ++m_map_it;
-                m_lst_it = m_map_it->second.cbegin();
+                skip_empty_lists();
             }
 
             return *this;
@@ -142,10 +142,20 @@ public:
         const_iterator operator++(int) { const_iterator tmp = *this; ++(*this); return tmp; }
 
         friend bool operator==(const const_iterator& a, const const_iterator& b) { return a.m_map_it == b.m_map_it && a.m_lst_it == b.m_lst_it; };
-        friend bool operator!=(const const_iterator& a, const const_iterator& b) { return a.m_map_it != b.m_map_it && a.m_lst_it != b.m_lst_it; };
+        friend bool operator!=(const const_iterator& a, const const_iterator& b) { return !(a == b); };
 
     private:
+        void skip_empty_lists() {
+            while (m_map_it != m_map_end && m_map_it->second.empty()) {
+                ++m_map_it;
+            }
+
+            // past the last list, every iterator holds the same empty list iterator
+            m_lst_it = m_map_it != m_map_end ? m_map_it->second.cbegin() : attr_list::const_iterator();
+        }
+
         attr_map::const_iterator m_map_it;
+        attr_map::const_iterator m_map_end;
         attr_list::const_iterator m_lst_it;
     };
 
@@ -316,7 +326,7 @@ attribute_container::const_attr_type_iterator<T> attribute_container::end_attr()
 #define DECLARE_SDP_ATTRIBUTE(a_name, str_name, flags_int) \
     namespace sippy::sdp::attributes { \
         struct a_name; \
-        std::istream& operator>>(std::istream& is, a_name & a); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, a_name & a); \
         std::ostream& operator<<(std::ostream& os, const a_name & a); \
         namespace meta { \
             template<> struct _attribute_detail<sippy::sdp::attributes::a_name> { \
@@ -324,7 +334,7 @@ attribute_container::const_attr_type_iterator<T> attribute_container::end_attr()
                 static constexpr uint32_t flags() { return (flags_int) ; } \
             }; \
             template<> struct _attribute_reader<sippy::sdp::attributes::a_name> { \
-                static void read(std::istream& is, sippy::sdp::attributes::a_name & a) { is >> a; } \
+                static void read(sippy::serialization::span_reader& reader, sippy::sdp::attributes::a_name & a) { reader >> a; } \
             }; \
             template<> struct _attribute_writer<sippy::sdp::attributes::a_name> { \
                 static void write(std::ostream& os, sippy::sdp::attributes::a_name & a) { os << a; } \
@@ -335,13 +345,13 @@ attribute_container::const_attr_type_iterator<T> attribute_container::end_attr()
 
 #define DEFINE_SDP_ATTRIBUTE_READ(a_name) \
     namespace sippy::sdp::attributes { \
-        static void read_attribute_ ##a_name(std::istream& is, a_name & a); \
-        std::istream& operator>>(std::istream& is, a_name & a) { \
-            read_attribute_ ##a_name(is, a); \
-            return is; \
+        static void read_attribute_ ##a_name(serialization::span_reader& reader, a_name & a); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, a_name & a) { \
+            read_attribute_ ##a_name(reader, a); \
+            return reader; \
         } \
     } \
-    static void sippy::sdp::attributes::read_attribute_ ##a_name(std::istream& is, a_name & a)
+    static void sippy::sdp::attributes::read_attribute_ ##a_name(sippy::serialization::span_reader& reader, a_name & a)
 
 
 #define DEFINE_SDP_ATTRIBUTE_WRITE(a_name) \
@@ -371,11 +381,13 @@ DECLARE_SDP_ATTRIBUTE(maxptime, "maxptime", flag_media_level) {
 DECLARE_SDP_ATTRIBUTE(rtpmap, "rtpmap", flag_media_level | flag_allow_multiple) {
     uint32_t payload_type;
     std::string encoding_name;
-    uint16_t clock_rate;
+    uint32_t clock_rate;
     uint8_t channels;
 };
 
 DECLARE_SDP_ATTRIBUTE(fmtp, "fmtp", flag_media_level | flag_allow_multiple) {
     uint32_t payload_type;
-    std::map<std::string, std::string> params;
+    util::small_map<std::string, std::string> params;
+    // parameters which are not name=value pairs (like 0-15 for telephone-event) are kept as is
+    std::string parameters;
 };
@@ -6,6 +6,7 @@
 #include <map>
 #include <chrono>
 
+#include <util/small_map.h>
 #include <sdp/types.h>
 #include <sdp/message.h>
 
@@ -88,16 +89,19 @@ public:
     void set_protocol(transport_protocol protocol, uint16_t port, uint16_t port_count = 1);
     void add_format(uint16_t format);
 
-    void add_rtpmap(uint16_t format, std::string_view name, uint16_t clock_rate, uint8_t channels = 0);
+    void add_rtpmap(uint16_t format, std::string_view name, uint32_t clock_rate, uint8_t channels = 0);
     void add_fmtp(uint16_t format, std::string_view name, std::string_view value);
+    // for formats whose parameters are not name=value pairs
+    void set_fmtp(uint16_t format, std::string_view parameters);
 
 private:
     struct format {
         uint16_t id;
         std::optional<std::string> name;
-        std::optional<uint16_t> clock_rate;
+        std::optional<uint32_t> clock_rate;
         std::optional<uint8_t> channels;
-        std::map<std::string, std::string, std::less<>> params;
+        util::small_map<std::string, std::string> params;
+        std::string parameters;
     };
 
     sdp::media_type m_type;
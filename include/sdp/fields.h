@@ -46,7 +46,7 @@ struct _field_writer {};
     namespace sippy::sdp::fields { \
         struct f_name; \
         bool _validate_field_ ##f_name(const f_name & f);\
-        std::istream& operator>>(std::istream& is, f_name & f); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, f_name & f); \
         std::ostream& operator<<(std::ostream& os, const f_name & f); \
         namespace meta { \
             template<> struct _field_detail<sippy::sdp::fields::f_name> { \
@@ -56,7 +56,7 @@ struct _field_writer {};
                 static bool validate(const sippy::sdp::fields::f_name & f) { return _validate_field_ ##f_name(f); } \
             }; \
             template<> struct _field_reader<sippy::sdp::fields::f_name> { \
-                static void read(std::istream& is, sippy::sdp::fields::f_name & f) { is >> f; } \
+                static void read(sippy::serialization::span_reader& reader, sippy::sdp::fields::f_name & f) { reader >> f; } \
             }; \
             template<> struct _field_writer<sippy::sdp::fields::f_name> { \
                 static void write(std::ostream& os, sippy::sdp::fields::f_name & f) { os << f; } \
@@ -72,13 +72,13 @@ struct _field_writer {};
 
 #define DEFINE_SDP_FIELD_READ(f_name) \
     namespace sippy::sdp::fields { \
-        static void read_field_ ##f_name(std::istream& is, f_name & f); \
-        std::istream& operator>>(std::istream& is, f_name & f) { \
-            read_field_ ##f_name(is, f); \
-            return is; \
+        static void read_field_ ##f_name(serialization::span_reader& reader, f_name & f); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, f_name & f) { \
+            read_field_ ##f_name(reader, f); \
+            return reader; \
         } \
     } \
-    static void sippy::sdp::fields::read_field_ ##f_name(std::istream& is, f_name & f)
+    static void sippy::sdp::fields::read_field_ ##f_name(sippy::serialization::span_reader& reader, f_name & f)
 
 
 #define DEFINE_SDP_FIELD_WRITE(f_name) \
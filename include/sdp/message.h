@@ -4,6 +4,7 @@
 #include <optional>
 #include <vector>
 #include <span>
+#include <expected>
 
 #include <sdp/fields.h>
 #include <sdp/attributes.h>
@@ -70,10 +71,43 @@ struct description_message {
     //  *attribute
 };
 
+enum class parse_error_code {
+    unexpected_character,
+    not_enough_characters,
+    bad_number,
+    unknown_value,
+    invalid_value,
+    missing_field,
+    field_trailing_data,
+    invalid_message
+};
+
+struct parse_error {
+    parse_error_code code;
+    size_t offset; // from the start of the parsed buffer
+    std::string field; // field or attribute name, empty if not inside one
+};
+
+class parse_exception final : public std::exception {
+public:
+    explicit parse_exception(parse_error error);
+
+    [[nodiscard]] const parse_error& error() const;
+    [[nodiscard]] const char* what() const noexcept override;
+
+private:
+    parse_error m_error;
+};
+
+const char* parse_error_str(parse_error_code code);
+
+// returns a description of the first invalid field, or nullptr if the message is valid
+const char* find_invalid_field(const description_message& message);
 void validate_message(const description_message& message);
 
 description_message parse(std::istream& is);
 description_message parse(std::span<const uint8_t> buffer);
+std::expected<description_message, parse_error> try_parse(std::span<const uint8_t> buffer);
 
 void write(std::ostream& os, const description_message& message);
 ssize_t write(std::span<uint8_t> buffer, const description_message& message);
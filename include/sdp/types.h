@@ -2,6 +2,12 @@
 
 #include <iostream>
 
+namespace sippy::serialization {
+
+class span_reader;
+
+}
+
 namespace sippy::sdp {
 
 enum class version {
@@ -52,4 +58,11 @@ std::ostream& operator<<(std::ostream& os, address_type address_type);
 std::istream& operator>>(std::istream& is, media_direction& media_direction);
 std::ostream& operator<<(std::ostream& os, media_direction media_direction);
 
+serialization::span_reader& operator>>(serialization::span_reader& reader, version& version);
+serialization::span_reader& operator>>(serialization::span_reader& reader, media_type& media_type);
+serialization::span_reader& operator>>(serialization::span_reader& reader, transport_protocol& transport_protocol);
+serialization::span_reader& operator>>(serialization::span_reader& reader, network_type& network_type);
+serialization::span_reader& operator>>(serialization::span_reader& reader, address_type& address_type);
+serialization::span_reader& operator>>(serialization::span_reader& reader, media_direction& media_direction);
+
 }
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <utility>
+
+namespace sippy::sip {
+
+// header and body holders are allocated from the memory resource of the message holding them,
+// which is either the heap or an arena released at once with the message.
+template<typename Base>
+struct _holder_deleter {
+    std::pmr::memory_resource* resource = nullptr;
+    size_t size = 0;
+
+    void operator()(Base* holder) const {
+        holder->~Base();
+        resource->deallocate(holder, size, alignof(std::max_align_t));
+    }
+};
+
+template<typename Base>
+using _holder_ptr = std::unique_ptr<Base, _holder_deleter<Base>>;
+
+template<typename Holder, typename Base, typename... Args>
+_holder_ptr<Base> _make_holder(std::pmr::memory_resource* resource, Args&&... args) {
+    static_assert(alignof(Holder) <= alignof(std::max_align_t));
+
+    void* memory = resource->allocate(sizeof(Holder), alignof(std::max_align_t));
+    Holder* holder;
+    try {
+        holder = new (memory) Holder(std::forward<Args>(args)...);
+    } catch (...) {
+        resource->deallocate(memory, sizeof(Holder), alignof(std::max_align_t));
+        throw;
+    }
+
+    return _holder_ptr<Base>(holder, _holder_deleter<Base>{resource, sizeof(Holder)});
+}
+
+}
@@ -5,6 +5,13 @@
 
 #include <sdp/message.h>
 #include <sdp/description.h>
+#include <sip/arena.h>
+
+namespace sippy::serialization {
+
+class span_reader;
+
+}
 
 namespace sippy::sip::bodies {
 
@@ -29,14 +36,14 @@ namespace storage {
 
 struct _base_body_holder;
 
-using _body_holder_ptr = std::unique_ptr<_base_body_holder>;
+using _body_holder_ptr = _holder_ptr<_base_body_holder>;
 
 struct _base_body_holder {
     virtual ~_base_body_holder() = default;
 
     [[nodiscard]] virtual const char* type() const = 0;
     [[nodiscard]] virtual bool is_of_type(const std::string& type) const = 0;
-    virtual std::istream& operator>>(std::istream& is) = 0;
+    virtual serialization::span_reader& operator>>(serialization::span_reader& reader) = 0;
     virtual std::ostream& operator<<(std::ostream& os) = 0;
 };
 
@@ -48,9 +55,9 @@ struct _body_holder final : _base_body_holder {
     [[nodiscard]] bool is_of_type(const std::string& type) const override {
         return type == meta::_body_detail<T>::app_type();
     }
-    std::istream& operator>>(std::istream& is) override {
-        is >> value;
-        return is;
+    serialization::span_reader& operator>>(serialization::span_reader& reader) override {
+        reader >> value;
+        return reader;
     }
     std::ostream& operator<<(std::ostream& os) override {
         os << value;
@@ -64,7 +71,7 @@ struct _base_body_def {
     virtual ~_base_body_def() = default;
 
     [[nodiscard]] virtual const char* application_type() const = 0;
-    [[nodiscard]] virtual _body_holder_ptr create() const = 0;
+    [[nodiscard]] virtual _body_holder_ptr create(std::pmr::memory_resource* resource) const = 0;
 };
 
 template<meta::_body_type T>
@@ -72,8 +79,8 @@ struct _body_def final : _base_body_def {
     [[nodiscard]] const char* application_type() const override {
         return meta::_body_detail<T>::app_type();
     }
-    [[nodiscard]] _body_holder_ptr create() const override {
-        return std::make_unique<_body_holder<T>>();
+    [[nodiscard]] _body_holder_ptr create(std::pmr::memory_resource* resource) const override {
+        return _make_holder<_body_holder<T>, _base_body_holder>(resource);
     }
 };
 
@@ -93,14 +100,14 @@ void register_body() {
 #define DECLARE_SIP_BODY(b_name, app_type_str) \
     namespace sippy::sip::bodies { \
         struct b_name; \
-        std::istream& operator>>(std::istream& is, b_name & b); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, b_name & b); \
         std::ostream& operator<<(std::ostream& os, const b_name & b); \
         namespace meta { \
             template<> struct _body_detail<sippy::sip::bodies::b_name> { \
                 static constexpr const char* app_type() { return (app_type_str) ; } \
             }; \
             template<> struct _body_reader<sippy::sip::bodies::b_name> { \
-                static void read(std::istream& is, sippy::sip::bodies::b_name & h) { is >> h; } \
+                static void read(sippy::serialization::span_reader& reader, sippy::sip::bodies::b_name & h) { reader >> h; } \
             }; \
             template<> struct _body_writer<sippy::sip::bodies::b_name> { \
                 static void write(std::ostream& os, const sippy::sip::bodies::b_name & h) { os << h; } \
@@ -111,13 +118,13 @@ void register_body() {
 
 #define DEFINE_SIP_BODY_READ(b_name) \
     namespace sippy::sip::bodies { \
-        static void read_body_ ##b_name(std::istream& is, b_name & b); \
-        std::istream& operator>>(std::istream& is, b_name & b) { \
-            read_body_ ##b_name(is, b); \
-            return is; \
+        static void read_body_ ##b_name(serialization::span_reader& reader, b_name & b); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, b_name & b) { \
+            read_body_ ##b_name(reader, b); \
+            return reader; \
         } \
     } \
-    static void sippy::sip::bodies::read_body_ ##b_name(std::istream& is, b_name & b)
+    static void sippy::sip::bodies::read_body_ ##b_name(sippy::serialization::span_reader& reader, b_name & b)
 
 #define DEFINE_SIP_BODY_WRITE(b_name) \
     namespace sippy::sip::bodies { \
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <expected>
+
+#include <sip/message.h>
+
+namespace sippy::sip {
+
+// offsets of the start line and header lines of a message, found in one pass without
+// building a message. headers are decoded one at a time on access.
+// the indexed buffer must outlive the index.
+class header_index {
+public:
+    static constexpr size_t max_headers = 64;
+
+    static std::expected<header_index, parse_error> build(std::span<const uint8_t> buffer);
+
+    [[nodiscard]] std::string_view start_line() const;
+    [[nodiscard]] bool is_request() const;
+    [[nodiscard]] bool is_response() const;
+    // offset of the body, right after the empty line which ends the headers
+    [[nodiscard]] size_t body_offset() const;
+
+    [[nodiscard]] size_t line_count() const;
+    [[nodiscard]] std::string_view name(size_t line) const;
+    // as in the buffer, folded values still include their line breaks
+    [[nodiscard]] std::string_view raw_value(size_t line) const;
+
+    template<headers::meta::_header_type T>
+    [[nodiscard]] bool has_header() const;
+    template<headers::meta::_header_type T>
+    [[nodiscard]] size_t header_count() const;
+    template<headers::meta::_header_type T>
+    T header(size_t index = 0) const;
+
+private:
+    struct line {
+        uint32_t name_offset;
+        uint32_t value_offset;
+        uint32_t value_size;
+        uint16_t name_size;
+        bool folded;
+    };
+
+    explicit header_index(std::string_view buffer);
+
+    [[nodiscard]] bool _is_header(const line& line, std::string_view name) const;
+    [[nodiscard]] std::optional<std::string_view> _find_value(std::string_view name, bool allow_multiple, size_t index, std::string& buffer) const;
+    [[nodiscard]] size_t _header_count(std::string_view name, bool allow_multiple) const;
+    void _decode_header(headers::storage::_base_header_holder& holder, size_t index) const;
+
+    std::string_view m_buffer;
+    uint32_t m_start_line_size;
+    uint32_t m_body_offset;
+    std::array<line, max_headers> m_lines;
+    size_t m_line_count;
+};
+
+template<headers::meta::_header_type T>
+bool header_index::has_header() const {
+    return header_count<T>() > 0;
+}
+
+template<headers::meta::_header_type T>
+size_t header_index::header_count() const {
+    const auto& name = headers::meta::_header_detail<T>::name();
+    const auto flags = headers::meta::_header_detail<T>::flags();
+    return _header_count(name, (flags & headers::flag_allow_multiple) != 0);
+}
+
+template<headers::meta::_header_type T>
+T header_index::header(size_t index) const {
+    headers::storage::_header_holder<T> holder;
+    _decode_header(holder, index);
+    return std::move(holder.mutable_value());
+}
+
+}
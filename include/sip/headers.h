@@ -1,11 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <exception>
 #include <optional>
 #include <memory>
+#include <mutex>
 #include <map>
+#include <string>
 
+#include <util/small_map.h>
 #include <sip/types.h>
+#include <sip/arena.h>
+
+namespace sippy::serialization {
+
+class span_reader;
+
+}
 
 namespace sippy::sip::headers {
 
@@ -30,8 +43,66 @@ namespace meta {
 template<typename T>
 concept _header_type = std::is_base_of_v<_header, T>;
 
+// the built-in headers as (type, name, compact form), this is the only list of them.
+// each gets a dense id by its position, which indexes its storage in a message.
+// sorted like the keys of a std::map, so messages keep listing them in the same order.
+// compact forms are from RFC 3261 section 7.3.3, empty for headers which have none.
+#define SIPPY_KNOWN_HEADERS(X) \
+    X(allow, "Allow", "") \
+    X(authorization, "Authorization", "") \
+    X(cseq, "CSeq", "") \
+    X(call_id, "Call-ID", "i") \
+    X(contact, "Contact", "m") \
+    X(content_length, "Content-Length", "l") \
+    X(content_type, "Content-Type", "c") \
+    X(expires, "Expires", "") \
+    X(from, "From", "f") \
+    X(max_forwards, "Max-Forwards", "") \
+    X(min_expires, "Min-Expires", "") \
+    X(record_route, "Record-Route", "") \
+    X(route, "Route", "") \
+    X(server, "Server", "") \
+    X(subject, "Subject", "s") \
+    X(to, "To", "t") \
+    X(via, "Via", "v") \
+    X(www_authorization, "WWW-Authenticate", "")
+
+enum class _known_header : size_t {
+#define SIPPY_KNOWN_HEADER_ID(h_name, str_name, compact_name) h_name,
+    SIPPY_KNOWN_HEADERS(SIPPY_KNOWN_HEADER_ID)
+#undef SIPPY_KNOWN_HEADER_ID
+};
+
+inline constexpr auto _known_headers = std::to_array<std::string_view>({
+#define SIPPY_KNOWN_HEADER_NAME(h_name, str_name, compact_name) str_name,
+    SIPPY_KNOWN_HEADERS(SIPPY_KNOWN_HEADER_NAME)
+#undef SIPPY_KNOWN_HEADER_NAME
+});
+
+inline constexpr auto _known_compact_headers = std::to_array<std::string_view>({
+#define SIPPY_KNOWN_HEADER_COMPACT_NAME(h_name, str_name, compact_name) compact_name,
+    SIPPY_KNOWN_HEADERS(SIPPY_KNOWN_HEADER_COMPACT_NAME)
+#undef SIPPY_KNOWN_HEADER_COMPACT_NAME
+});
+
+static_assert(std::ranges::is_sorted(_known_headers), "SIPPY_KNOWN_HEADERS must stay sorted by name");
+
+// id of headers declared outside the library, these are stored by name
+inline constexpr size_t _dynamic_header_id = _known_headers.size();
+
+consteval size_t _header_id(const std::string_view name) {
+    for (size_t i = 0; i < _known_headers.size(); i++) {
+        if (_known_headers[i] == name) {
+            return i;
+        }
+    }
+
+    return _dynamic_header_id;
+}
+
 template<typename T>
 struct _header_detail {};
+
 template<typename T>
 struct _header_reader {};
 template<typename T>
@@ -43,49 +114,105 @@ namespace storage {
 
 struct _base_header_holder;
 
-using _header_holder_ptr = std::unique_ptr<_base_header_holder>;
+// wire value of a header kept raw by lazy parsing. a view into the received buffer, which it
+// keeps alive.
+class _raw_value {
+public:
+    _raw_value(std::string_view value, std::shared_ptr<const void> buffer);
+
+    [[nodiscard]] std::string_view view() const;
+
+private:
+    std::string_view m_value;
+    std::shared_ptr<const void> m_buffer;
+};
+
+using _header_holder_ptr = _holder_ptr<_base_header_holder>;
 
 struct _base_header_holder {
     virtual ~_base_header_holder() = default;
 
     [[nodiscard]] virtual const char* name() const = 0;
+    [[nodiscard]] virtual size_t id() const = 0;
     [[nodiscard]] virtual uint32_t flags() const = 0;
-    [[nodiscard]] virtual _header_holder_ptr copy() const = 0;
-    virtual std::istream& operator>>(std::istream& is) = 0;
-    virtual std::ostream& operator<<(std::ostream& os) = 0;
+    [[nodiscard]] virtual _header_holder_ptr copy(std::pmr::memory_resource* resource) const = 0;
+    virtual serialization::span_reader& operator>>(serialization::span_reader& reader) = 0;
+    virtual std::ostream& operator<<(std::ostream& os) const = 0;
+
+    // reads raw into the value. only called once, by the first access to the value
+    virtual void _decode_raw(serialization::span_reader& reader) const = 0;
+
+    // set while the value is as received, so it is written back as is. not changed by const
+    // access, only by changing the value.
+    std::optional<_raw_value> raw;
 };
 
+// decodes the raw value of the holder, throws parse_exception if it is not valid
+void _decode(const _base_header_holder& holder);
+
 template<meta::_header_type T>
 struct _header_holder final : _base_header_holder {
     [[nodiscard]] const char* name() const override {
         return meta::_header_detail<T>::name();
     }
+    [[nodiscard]] size_t id() const override {
+        return meta::_header_detail<T>::id();
+    }
     [[nodiscard]] uint32_t flags() const override {
         return meta::_header_detail<T>::flags();
     }
-    [[nodiscard]] _header_holder_ptr copy() const override {
-        auto cpy = std::make_unique<_header_holder>();
-        cpy->value = value;
-        return std::move(cpy);
+    [[nodiscard]] _header_holder_ptr copy(std::pmr::memory_resource* resource) const override {
+        if (raw.has_value()) {
+            // the copy decodes the raw value on its own when accessed
+            auto cpy = _make_holder<_header_holder, _base_header_holder>(resource);
+            cpy->raw = raw;
+            return cpy;
+        }
+
+        return _make_holder<_header_holder, _base_header_holder>(resource, share());
     }
-    std::istream& operator>>(std::istream& is) override {
-        is >> value;
-        return is;
+    serialization::span_reader& operator>>(serialization::span_reader& reader) override {
+        reader >> mutable_value();
+        return reader;
     }
-    std::ostream& operator<<(std::ostream& os) override {
-        os << value;
+    std::ostream& operator<<(std::ostream& os) const override {
+        os << value();
         return os;
     }
+    void _decode_raw(serialization::span_reader& reader) const override {
+        reader >> m_value;
+    }
 
-    T value;
+    _header_holder() = default;
+    explicit _header_holder(std::shared_ptr<const T> shared);
+
+    // a raw value is decoded on first access, which is safe from several threads
+    [[nodiscard]] const T& value() const;
+    // a value shared with copies of the header is copied before it can be changed
+    T& mutable_value();
+
+private:
+    std::shared_ptr<const T> share() const;
+
+    // the value is kept in the holder. the first copy of the header puts a copy of it on the
+    // heap, which later copies share until one of them changes it. that and decoding a raw
+    // value are added to the holder under synchronization, so a header can be read and copied
+    // from several threads at once.
+    mutable T m_value;
+    mutable std::once_flag m_decoded;
+    // the value of a holder copied from another one
+    std::shared_ptr<const T> m_shared;
+    // the copy of m_value shared with copies of this holder
+    mutable std::atomic<std::shared_ptr<const T>> m_copies;
 };
 
 struct _base_header_def {
     virtual ~_base_header_def() = default;
 
     [[nodiscard]] virtual const char* name() const = 0;
+    [[nodiscard]] virtual size_t id() const = 0;
     [[nodiscard]] virtual uint32_t flags() const = 0;
-    [[nodiscard]] virtual _header_holder_ptr create() const = 0;
+    [[nodiscard]] virtual _header_holder_ptr create(std::pmr::memory_resource* resource) const = 0;
 };
 
 template<meta::_header_type T>
@@ -93,16 +220,71 @@ struct _header_def final : _base_header_def {
     [[nodiscard]] const char* name() const override {
         return meta::_header_detail<T>::name();
     }
+    [[nodiscard]] size_t id() const override {
+        return meta::_header_detail<T>::id();
+    }
     [[nodiscard]] uint32_t flags() const override {
         return meta::_header_detail<T>::flags();
     }
-    [[nodiscard]] _header_holder_ptr create() const override {
-        return std::make_unique<_header_holder<T>>();
+    [[nodiscard]] _header_holder_ptr create(std::pmr::memory_resource* resource) const override {
+        return _make_holder<_header_holder<T>, _base_header_holder>(resource);
     }
 };
 
 void _register_header_internal(const std::string& name, std::shared_ptr<_base_header_def> ptr);
 
+template<meta::_header_type T>
+_header_holder<T>::_header_holder(std::shared_ptr<const T> shared)
+    : m_value()
+    , m_decoded()
+    , m_shared(std::move(shared))
+    , m_copies()
+{}
+
+template<meta::_header_type T>
+const T& _header_holder<T>::value() const {
+    if (m_shared) {
+        return *m_shared;
+    }
+    if (raw.has_value()) {
+        std::call_once(m_decoded, _decode, *this);
+    }
+
+    return m_value;
+}
+
+template<meta::_header_type T>
+T& _header_holder<T>::mutable_value() {
+    if (m_shared) {
+        m_value = *m_shared;
+        m_shared.reset();
+    } else if (raw.has_value()) {
+        std::call_once(m_decoded, _decode, *this);
+    }
+
+    raw.reset();
+    m_copies.store(nullptr);
+    return m_value;
+}
+
+template<meta::_header_type T>
+std::shared_ptr<const T> _header_holder<T>::share() const {
+    if (m_shared) {
+        return m_shared;
+    }
+
+    auto shared = m_copies.load();
+    if (!shared) {
+        auto created = std::make_shared<const T>(m_value);
+        // another thread may have shared it first, then use that one
+        if (m_copies.compare_exchange_strong(shared, created)) {
+            shared = std::move(created);
+        }
+    }
+
+    return shared;
+}
+
 }
 
 template<meta::_header_type T>
@@ -117,120 +299,127 @@ void register_header() {
 #define DECLARE_SIP_HEADER(h_name, str_name, flags_int) \
     namespace sippy::sip::headers { \
         struct h_name; \
-        std::istream& operator>>(std::istream& is, h_name & h); \
-        std::ostream& operator<<(std::ostream& os, h_name & h); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, h_name & h); \
+        std::ostream& operator<<(std::ostream& os, const h_name & h); \
         namespace meta { \
             template<> struct _header_detail<sippy::sip::headers::h_name> { \
                 static constexpr const char* name() { return (str_name) ; } \
+                static constexpr size_t id() { return _header_id(str_name) ; } \
                 static constexpr uint32_t flags() { return (flags_int) ; } \
             }; \
             template<> struct _header_reader<sippy::sip::headers::h_name> { \
-                static void read(std::istream& is, sippy::sip::headers::h_name & h) { is >> h; } \
+                static void read(sippy::serialization::span_reader& reader, sippy::sip::headers::h_name & h) { reader >> h; } \
             }; \
             template<> struct _header_writer<sippy::sip::headers::h_name> { \
-                static void write(std::ostream& os, sippy::sip::headers::h_name & h) { os << h; } \
+                static void write(std::ostream& os, const sippy::sip::headers::h_name & h) { os << h; } \
             }; \
         } \
     } \
     struct sippy::sip::headers::h_name : sippy::sip::headers::_header
 
+// declares a built-in header, its name is the one in SIPPY_KNOWN_HEADERS
+#define DECLARE_KNOWN_SIP_HEADER(h_name, flags_int) \
+    DECLARE_SIP_HEADER(h_name, \
+        sippy::sip::headers::meta::_known_headers[static_cast<size_t>(sippy::sip::headers::meta::_known_header::h_name)].data(), \
+        flags_int)
+
 #define DEFINE_SIP_HEADER_READ(h_name) \
     namespace sippy::sip::headers { \
-        static void read_header_ ##h_name(std::istream& is, h_name & h); \
-        std::istream& operator>>(std::istream& is, h_name & h) { \
-            read_header_ ##h_name(is, h); \
-            return is; \
+        static void read_header_ ##h_name(serialization::span_reader& reader, h_name & h); \
+        serialization::span_reader& operator>>(serialization::span_reader& reader, h_name & h) { \
+            read_header_ ##h_name(reader, h); \
+            return reader; \
         } \
     } \
-    static void sippy::sip::headers::read_header_ ##h_name(std::istream& is, h_name & h)
+    static void sippy::sip::headers::read_header_ ##h_name(sippy::serialization::span_reader& reader, h_name & h)
 
 #define DEFINE_SIP_HEADER_WRITE(h_name) \
     namespace sippy::sip::headers { \
-        static void write_header_ ##h_name(std::ostream& os, h_name & h); \
-        std::ostream& operator<<(std::ostream& os, h_name & h) { \
+        static void write_header_ ##h_name(std::ostream& os, const h_name & h); \
+        std::ostream& operator<<(std::ostream& os, const h_name & h) { \
             write_header_ ##h_name(os, h); \
             return os; \
         } \
     } \
-    static void sippy::sip::headers::write_header_ ##h_name(std::ostream& os, h_name & h)
+    static void sippy::sip::headers::write_header_ ##h_name(std::ostream& os, const h_name & h)
 
 
-DECLARE_SIP_HEADER(from, "From", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(from, flag_none) {
     std::optional<std::string> display_name;
     std::string uri;
     std::optional<std::string> tag;
 };
 
-DECLARE_SIP_HEADER(to, "To", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(to, flag_none) {
     std::optional<std::string> display_name;
     std::string uri;
     std::optional<std::string> tag;
 };
 
-DECLARE_SIP_HEADER(contact, "Contact", flag_priority_top | flag_allow_multiple) {
+DECLARE_KNOWN_SIP_HEADER(contact, flag_priority_top | flag_allow_multiple) {
     std::optional<std::string> display_name;
     std::string uri;
-    std::map<std::string, std::string> tags;
+    util::small_map<std::string, param_value> tags;
 };
 
-DECLARE_SIP_HEADER(via, "Via", flag_priority_top | flag_allow_multiple) {
+DECLARE_KNOWN_SIP_HEADER(via, flag_priority_top | flag_allow_multiple) {
     sip::version version;
     sip::transport transport;
     std::string host;
     std::optional<uint16_t> port;
-    std::map<std::string, std::string> tags;
+    util::small_map<std::string, param_value> tags;
 };
 
-DECLARE_SIP_HEADER(content_length, "Content-Length", flag_priority_top | flag_autogenerated) {
+DECLARE_KNOWN_SIP_HEADER(content_length, flag_priority_top | flag_autogenerated) {
     uint32_t length;
 };
 
-DECLARE_SIP_HEADER(content_type, "Content-Type", flag_priority_top | flag_autogenerated) {
+DECLARE_KNOWN_SIP_HEADER(content_type, flag_priority_top | flag_autogenerated) {
     std::string type;
 };
 
-DECLARE_SIP_HEADER(cseq, "CSeq", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(cseq, flag_none) {
     uint32_t seq_num;
     sip::method method;
 };
 
-DECLARE_SIP_HEADER(call_id, "Call-ID", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(call_id, flag_none) {
     std::string value;
 };
 
-DECLARE_SIP_HEADER(max_forwards, "Max-Forwards", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(max_forwards, flag_none) {
     uint32_t value;
 };
 
-DECLARE_SIP_HEADER(min_expires, "Min-Expires", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(min_expires, flag_none) {
     uint32_t value;
 };
 
-DECLARE_SIP_HEADER(expires, "Expires", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(expires, flag_none) {
     uint32_t value;
 };
 
-DECLARE_SIP_HEADER(route, "Route", flag_priority_top | flag_allow_multiple) {
+DECLARE_KNOWN_SIP_HEADER(route, flag_priority_top | flag_allow_multiple) {
     std::string uri;
 };
 
-DECLARE_SIP_HEADER(record_route, "Record-Route", flag_priority_top | flag_allow_multiple) {
+DECLARE_KNOWN_SIP_HEADER(record_route, flag_priority_top | flag_allow_multiple) {
     std::string uri;
 };
 
-DECLARE_SIP_HEADER(server, "Server", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(server, flag_none) {
     std::string value;
 };
 
-DECLARE_SIP_HEADER(subject, "Subject", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(subject, flag_none) {
     std::string value;
 };
 
-DECLARE_SIP_HEADER(allow, "Allow", flag_allow_multiple) {
-    sip::method method;
+DECLARE_KNOWN_SIP_HEADER(allow, flag_none) {
+    method_set methods;
 };
 
-DECLARE_SIP_HEADER(authorization, "Authorization", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(authorization, flag_none) {
     auth_scheme scheme;
     std::string username;
     std::string uri;
@@ -238,12 +427,12 @@ DECLARE_SIP_HEADER(authorization, "Authorization", flag_none) {
     auth_algorithm algorithm;
     std::string qop;
     std::string nonce;
-    std::optional<uint16_t> nc;
+    std::optional<uint32_t> nc;
     std::optional<std::string> cnonce;
     std::optional<std::string> response;
 };
 
-DECLARE_SIP_HEADER(www_authorization, "WWW-Authenticate", flag_none) {
+DECLARE_KNOWN_SIP_HEADER(www_authorization, flag_none) {
     auth_scheme scheme;
     std::string uri;
     std::string realm;
@@ -251,3 +440,13 @@ DECLARE_SIP_HEADER(www_authorization, "WWW-Authenticate", flag_none) {
     std::string qop;
     std::string nonce;
 };
+
+namespace sippy::sip::headers::meta {
+
+// every header in SIPPY_KNOWN_HEADERS must be declared with DECLARE_KNOWN_SIP_HEADER
+#define SIPPY_CHECK_KNOWN_HEADER(h_name, str_name, compact_name) \
+    static_assert(_header_detail<h_name>::id() == static_cast<size_t>(_known_header::h_name), #h_name " has the wrong id");
+SIPPY_KNOWN_HEADERS(SIPPY_CHECK_KNOWN_HEADER)
+#undef SIPPY_CHECK_KNOWN_HEADER
+
+}
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <array>
 #include <map>
+#include <memory_resource>
 #include <span>
 #include <vector>
+#include <expected>
 
+#include <util/enum_set.h>
 #include <sip/types.h>
 #include <sip/headers.h>
 #include <sip/bodies.h>
@@ -33,20 +37,122 @@ std::ostream& operator<<(std::ostream& os, const request_line& line);
 std::istream& operator>>(std::istream& is, status_line& line);
 std::ostream& operator<<(std::ostream& os, const status_line& line);
 
+// checked before parsing, so abusive input is rejected before anything is allocated.
+// zero means no limit.
+struct parse_limits {
+    size_t max_message_size = 0;
+    size_t max_headers = 0;
+    // name and value, continuation lines included
+    size_t max_header_line = 0;
+    size_t max_via_entries = 0;
+    size_t max_contact_entries = 0;
+    size_t max_body_size = 0;
+};
+
+class message;
+class message_pool;
+
+// gives messages taken from a pool back to it, others are deleted
+struct message_deleter {
+    message_deleter() = default;
+    message_deleter(std::default_delete<message>);
+    explicit message_deleter(message_pool* pool);
+
+    void operator()(message* msg) const;
+
+    message_pool* pool = nullptr;
+};
+
+using message_ptr = std::unique_ptr<message, message_deleter>;
+
+// built-in headers, by id
+using header_set = util::enum_set<headers::meta::_known_header, headers::meta::_known_headers.size()>;
+
+// headers which the library doesn't know and which aren't declared outside it are dropped while
+// parsing, in every mode, so they are not written back.
+struct parse_options {
+    // keep header values raw and decode each one on first access
+    bool lazy_headers = false;
+    // if not empty, only these headers are decoded while parsing. the rest are kept raw,
+    // written back as received and decoded on first access. headers declared outside the
+    // library can't be listed, they are kept raw.
+    header_set decoded_headers;
+    parse_limits limits;
+    // allocate the header and body holders and the header lists of the message from an arena
+    // owned by it, released at once when the message is destroyed. header values, raw values
+    // and body contents stay on the heap, since copies of a header share its value with other
+    // messages.
+    bool arena = false;
+    // take the message from this pool instead of allocating it, ignored with arena
+    message_pool* pool = nullptr;
+
+    // Content-Length and Content-Type are always decoded
+    [[nodiscard]] bool should_decode(size_t id) const;
+
+    template<headers::meta::_header_type... T>
+    static parse_options decode_only();
+};
+
+enum class parse_error_code {
+    unexpected_character,
+    not_enough_characters,
+    bad_number,
+    unknown_value,
+    invalid_value,
+    bad_start_line,
+    missing_header_value,
+    header_value_trailing_data,
+    missing_content_type,
+    unknown_body,
+    bad_body,
+    body_trailing_data,
+    too_many_headers,
+    message_too_large,
+    header_line_too_long,
+    too_many_header_values,
+    body_too_large,
+    bad_content_length
+};
+
+struct parse_error {
+    parse_error_code code;
+    // from the start of the parsed buffer. for lazily decoded headers, from the start of the header value.
+    size_t offset;
+    std::string header; // empty if not inside a header
+};
+
+class parse_exception final : public std::exception {
+public:
+    explicit parse_exception(parse_error error);
+
+    [[nodiscard]] const parse_error& error() const;
+    [[nodiscard]] const char* what() const noexcept override;
+
+private:
+    parse_error m_error;
+};
+
+const char* parse_error_str(parse_error_code code);
+
 class reader;
 class writer;
-class message;
-using message_ptr = std::unique_ptr<message>;
 
-message_ptr parse(std::istream& is);
-message_ptr parse(std::span<const uint8_t> buffer);
+message_ptr parse(std::istream& is, const parse_options& options = {});
+message_ptr parse(std::span<const uint8_t> buffer, const parse_options& options = {});
+std::expected<message_ptr, parse_error> try_parse(std::span<const uint8_t> buffer, const parse_options& options = {});
+
+// header values kept raw (lazy_headers or not in decoded_headers) borrow from the buffer instead of
+// copying it, and keep it alive. they only become owned strings when decoded on access.
+using shared_buffer = std::shared_ptr<const std::vector<uint8_t>>;
+message_ptr parse(shared_buffer buffer, const parse_options& options = {});
+std::expected<message_ptr, parse_error> try_parse(shared_buffer buffer, const parse_options& options = {});
 
 void write(std::ostream& os, message_ptr message);
 ssize_t write(std::span<uint8_t> buffer, message_ptr message);
 
 class header_container {
 public:
-    header_container() = default;
+    header_container();
     header_container(const header_container&) = delete;
     header_container(header_container&&) = default;
     ~header_container() = default;
@@ -57,8 +163,9 @@ public:
     [[nodiscard]] size_t header_count() const;
     template<headers::meta::_header_type T>
     const T& header(size_t index = 0) const;
+    // copies of a message share header values, so changing one goes through here to un-share it
     template<headers::meta::_header_type T>
-    T& header(size_t index = 0);
+    T& mutable_header(size_t index = 0);
 
     template<headers::meta::_header_type T>
     void add_header(const T& header);
@@ -74,24 +181,42 @@ public:
     void add_headers(header_container&& other);
 
 protected:
-    [[nodiscard]] size_t _header_count(const std::string& name) const;
-    [[nodiscard]] const headers::storage::_base_header_holder* _get_header(const std::string& name, size_t index) const;
-    headers::storage::_base_header_holder* _get_header(const std::string& name, size_t index);
-    void _add_header(const std::string& name, headers::storage::_header_holder_ptr holder);
-    void _copy_headers(const std::string& name, const header_container& other);
-    bool _remove_header(const std::string& name, size_t index);
-    bool _remove_headers(const std::string& name);
+    // the holders and lists stored in the container are allocated from the arena, which lives as long as it does
+    explicit header_container(std::unique_ptr<std::pmr::memory_resource> arena);
+
+    [[nodiscard]] std::pmr::memory_resource* _resource() const;
+    [[nodiscard]] size_t _header_count(size_t id, std::string_view name) const;
+    [[nodiscard]] const headers::storage::_base_header_holder* _get_header(size_t id, std::string_view name, size_t index) const;
+    headers::storage::_base_header_holder* _get_header(size_t id, std::string_view name, size_t index);
+    void _add_header(headers::storage::_header_holder_ptr holder);
+    void _copy_headers(size_t id, std::string_view name, const header_container& other);
+    bool _remove_header(size_t id, std::string_view name, size_t index);
+    bool _remove_headers(size_t id, std::string_view name);
+    // removes every header, keeping the capacity of the lists
+    void _clear_headers();
 
 private:
-    std::map<std::string, std::vector<headers::storage::_header_holder_ptr>> m_headers;
+    using _header_list = std::pmr::vector<headers::storage::_header_holder_ptr>;
+
+    [[nodiscard]] const _header_list* _find_headers(size_t id, std::string_view name) const;
+    [[nodiscard]] _header_list* _find_headers(size_t id, std::string_view name);
+
+    // declared first, so it is released after everything allocated from it
+    std::unique_ptr<std::pmr::memory_resource> m_arena;
+    std::pmr::memory_resource* m_resource;
+    // built-in headers are indexed by their id, others are kept by name
+    std::array<_header_list, headers::meta::_known_headers.size()> m_known_headers;
+    std::pmr::map<std::pmr::string, _header_list, std::less<>> m_dynamic_headers;
 
     friend class reader;
     friend class writer;
+    friend class message_pool;
 };
 
 class message : public header_container {
 public:
     message() = default;
+    explicit message(std::unique_ptr<std::pmr::memory_resource> arena);
     message(const message&) = delete;
     message(message&&) = default;
     ~message() = default;
@@ -129,6 +254,7 @@ private:
     [[nodiscard]] const bodies::storage::_base_body_holder* _get_body(const std::string& type) const;
     [[nodiscard]] bodies::storage::_base_body_holder* _get_body(const std::string& type);
     void _set_body(bodies::storage::_body_holder_ptr body);
+    void _reset();
 
     std::optional<sip::request_line> m_request_line;
     std::optional<sip::status_line> m_status_line;
@@ -136,8 +262,19 @@ private:
 
     friend class reader;
     friend class writer;
+    friend class message_pool;
 };
 
+template<headers::meta::_header_type... T>
+parse_options parse_options::decode_only() {
+    static_assert(((headers::meta::_header_detail<T>::id() < headers::meta::_dynamic_header_id) && ...),
+        "only built-in headers can be selected");
+
+    parse_options options;
+    options.decoded_headers = {static_cast<headers::meta::_known_header>(headers::meta::_header_detail<T>::id())...};
+    return options;
+}
+
 template<headers::meta::_header_type T>
 bool header_container::has_header() const {
     return header_count<T>() > 0;
@@ -145,24 +282,24 @@ bool header_container::has_header() const {
 
 template<headers::meta::_header_type T>
 size_t header_container::header_count() const {
-    const auto& name = headers::meta::_header_detail<T>::name();
-    return _header_count(name);
+    using detail = headers::meta::_header_detail<T>;
+    return _header_count(detail::id(), detail::name());
 }
 
 template<headers::meta::_header_type T>
 const T& header_container::header(size_t index) const {
-    const auto& name = headers::meta::_header_detail<T>::name();
+    using detail = headers::meta::_header_detail<T>;
 
-    auto holder = reinterpret_cast<const headers::storage::_header_holder<T>*>(_get_header(name, index));
-    return holder->value;
+    auto holder = reinterpret_cast<const headers::storage::_header_holder<T>*>(_get_header(detail::id(), detail::name(), index));
+    return holder->value();
 }
 
 template<headers::meta::_header_type T>
-T& header_container::header(size_t index) {
-    const auto& name = headers::meta::_header_detail<T>::name();
+T& header_container::mutable_header(size_t index) {
+    using detail = headers::meta::_header_detail<T>;
 
-    auto holder = reinterpret_cast<headers::storage::_header_holder<T>*>(_get_header(name, index));
-    return holder->value;
+    auto holder = reinterpret_cast<headers::storage::_header_holder<T>*>(_get_header(detail::id(), detail::name(), index));
+    return holder->mutable_value();
 }
 
 template<headers::meta::_header_type T>
@@ -173,30 +310,28 @@ void header_container::add_header(const T& header) {
 
 template<headers::meta::_header_type T>
 void header_container::add_header(T&& header) {
-    const auto& name = headers::meta::_header_detail<T>::name();
-
-    auto holder = std::make_unique<headers::storage::_header_holder<T>>();
-    holder->value = std::forward<T>(header);
+    auto holder = _make_holder<headers::storage::_header_holder<T>, headers::storage::_base_header_holder>(_resource());
+    static_cast<headers::storage::_header_holder<T>&>(*holder).mutable_value() = std::forward<T>(header);
 
-    _add_header(name, std::move(holder));
+    _add_header(std::move(holder));
 }
 
 template<headers::meta::_header_type T>
 void header_container::copy_headers(const header_container& other) {
-    const auto& name = headers::meta::_header_detail<T>::name();
-    _copy_headers(name, other);
+    using detail = headers::meta::_header_detail<T>;
+    _copy_headers(detail::id(), detail::name(), other);
 }
 
 template<headers::meta::_header_type T>
 bool header_container::remove_header(size_t index) {
-    const auto& name = headers::meta::_header_detail<T>::name();
-    return _remove_header(name, index);
+    using detail = headers::meta::_header_detail<T>;
+    return _remove_header(detail::id(), detail::name(), index);
 }
 
 template<headers::meta::_header_type T>
 bool header_container::remove_headers() {
-    const auto& name = headers::meta::_header_detail<T>::name();
-    return _remove_headers(name);
+    using detail = headers::meta::_header_detail<T>;
+    return _remove_headers(detail::id(), detail::name());
 }
 
 template<bodies::meta::_body_type T>
@@ -229,8 +364,8 @@ void message::set_body(const T& body) {
 
 template<bodies::meta::_body_type T>
 void message::set_body(T&& body) {
-    auto holder = std::make_unique<bodies::storage::_body_holder<T>>();
-    holder->value = std::forward<T>(body);
+    auto holder = _make_holder<bodies::storage::_body_holder<T>, bodies::storage::_base_body_holder>(_resource());
+    static_cast<bodies::storage::_body_holder<T>&>(*holder).value = std::forward<T>(body);
 
     _set_body(std::move(holder));
 }
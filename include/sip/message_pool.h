@@ -0,0 +1,38 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include <sip/message.h>
+
+namespace sippy::sip {
+
+// hands out messages which go back to the pool when their message_ptr is destroyed, instead of
+// being freed. recycled messages are cleared but keep the capacity of their header lists and the
+// entries of their unknown headers. the headers themselves are freed, so every header added to a
+// recycled message still allocates its holder and any long strings in its value.
+// not thread safe, use one per thread. must outlive every message acquired from it.
+class message_pool {
+public:
+    explicit message_pool(size_t max_size = 64);
+    message_pool(const message_pool&) = delete;
+    message_pool(message_pool&&) = delete;
+
+    message_ptr acquire();
+
+    // messages waiting to be acquired
+    [[nodiscard]] size_t size() const;
+
+private:
+    void recycle(message* msg);
+
+    size_t m_max_size;
+    std::vector<std::unique_ptr<message>> m_free;
+
+    friend struct message_deleter;
+};
+
+// from the pool if there is one, otherwise a new message
+message_ptr make_message(message_pool* pool);
+
+}
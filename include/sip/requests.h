@@ -1,6 +1,7 @@
 #pragma once
 
 #include <sip/message.h>
+#include <sip/message_pool.h>
 #include <sip/auth.h>
 
 namespace sippy::sip {
@@ -13,7 +14,8 @@ message_ptr create_request(
     std::string_view call_id,
     uint32_t sequence_num,
     uint32_t expires,
-    uint32_t max_forwards);
+    uint32_t max_forwards,
+    message_pool* pool = nullptr);
 
 message_ptr create_request_register(
     std::string_view target_uri,
@@ -21,7 +23,8 @@ message_ptr create_request_register(
     std::string_view call_id,
     uint32_t sequence_num,
     uint32_t expires,
-    uint32_t max_forwards
+    uint32_t max_forwards,
+    message_pool* pool = nullptr
 );
 
 headers::authorization create_request_authorization(
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <sip/message.h>
+#include <sip/message_pool.h>
 
 namespace sippy::sip {
 
@@ -9,6 +10,7 @@ message_ptr create_response(
     const sip::message& original_request,
     uint32_t expires,
     uint32_t max_forwards,
-    std::optional<std::string_view> phrase = std::nullopt);
+    std::optional<std::string_view> phrase = std::nullopt,
+    message_pool* pool = nullptr);
 
 }
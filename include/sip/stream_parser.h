@@ -0,0 +1,56 @@
+#pragma once
+
+#include <functional>
+#include <span>
+#include <vector>
+
+#include <sip/message.h>
+
+namespace sippy::sip {
+
+struct parse_many_result {
+    // in the order they appear in the buffer, each one parsed or failed on its own
+    std::vector<std::expected<message_ptr, parse_error>> messages;
+    // bytes after the last complete message, which need more data. empty after a framing error
+    std::span<const uint8_t> remaining;
+};
+
+// splits a buffer holding any number of messages framed by Content-Length, as read from a stream,
+// and parses every complete one. never throws: a message which can't be framed ends the result
+// with its error, and the rest of the buffer is dropped.
+// each message is parsed on its own, nothing is shared across the batch. type lookups are static
+// tables and messages are allocated as the options say (arena or pool), so there is no setup to share.
+parse_many_result parse_many(std::span<const uint8_t> buffer, const parse_options& options = {});
+
+class stream_parser {
+public:
+    using message_callback = std::function<void(message_ptr&&)>;
+    using error_callback = std::function<void(const parse_error&)>;
+
+    explicit stream_parser(parse_options options = {});
+
+    // feed data as it arrives from the stream, callback is called for each complete message.
+    // messages which fail to parse are skipped and reported to on_error. data which can't be
+    // framed is dropped and reported the same way. if callback throws, the remaining messages
+    // are still delivered and the first exception is rethrown at the end.
+    void feed(std::span<const uint8_t> data, const message_callback& callback, const error_callback& on_error = {});
+    void reset();
+
+    [[nodiscard]] size_t pending() const;
+
+private:
+    // nullopt until a complete message is buffered
+    std::expected<std::optional<std::span<const uint8_t>>, parse_error> next_frame(std::span<const uint8_t> buffer, size_t& offset);
+    // gives up on the data, it can't be framed
+    void drop(std::string_view data, size_t& offset);
+    void keep_remaining(std::span<const uint8_t> buffer, size_t offset);
+
+    parse_options m_options;
+    std::vector<uint8_t> m_buffer;
+    size_t m_scanned;
+    size_t m_frame_size;
+
+    friend parse_many_result parse_many(std::span<const uint8_t> buffer, const parse_options& options);
+};
+
+}
@@ -8,6 +8,7 @@
 
 #include <sip/types.h>
 #include <sip/message.h>
+#include <sip/stream_parser.h>
 
 namespace sippy::sip {
 
@@ -24,6 +25,10 @@ public:
     using read_callback = std::function<void(message_ptr&&)>;
     using error_callback = std::function<void(uint64_t)>;
 
+    // received messages which fail to parse are reported to on_error as this plus their parse_error_code,
+    // other errors come from the connection
+    static constexpr uint64_t parse_error_base = 1ull << 32;
+
     virtual ~channel() = default;
 
     virtual void on_read(read_callback&& callback) = 0;
@@ -61,6 +66,7 @@ public:
 
 private:
     looper::tcp m_tcp;
+    stream_parser m_parser;
     read_callback m_read_callback;
     error_callback m_error_callback;
 };
@@ -2,6 +2,15 @@
 
 #include <iostream>
 #include <optional>
+#include <string>
+
+#include <util/enum_set.h>
+
+namespace sippy::serialization {
+
+class span_reader;
+
+}
 
 namespace sippy::sip {
 
@@ -20,6 +29,8 @@ enum class method {
     register_,
 };
 
+using method_set = util::enum_set<method, static_cast<size_t>(method::register_) + 1>;
+
 enum class status_class {
     provisional = 1,
     success = 2,
@@ -127,6 +138,19 @@ enum class auth_algorithm {
     md5
 };
 
+// the value of a ;name=value header parameter. remembers whether it was quoted so it is written
+// back the way it was read. a parameter written without a value (like ;lr) has none.
+struct param_value {
+    param_value() = default;
+    param_value(std::string value, bool quoted = false);
+    param_value(const char* value);
+
+    bool operator==(const param_value& other) const = default;
+
+    std::optional<std::string> value;
+    bool quoted = false;
+};
+
 std::optional<method> try_get_method(std::string_view str);
 std::optional<version> try_get_version(std::string_view str);
 
@@ -148,4 +172,11 @@ std::ostream& operator<<(std::ostream& os, auth_scheme auth_scheme);
 std::istream& operator>>(std::istream& is, auth_algorithm& auth_algorithm);
 std::ostream& operator<<(std::ostream& os, auth_algorithm auth_algorithm);
 
+serialization::span_reader& operator>>(serialization::span_reader& reader, method& method);
+serialization::span_reader& operator>>(serialization::span_reader& reader, status_code& code);
+serialization::span_reader& operator>>(serialization::span_reader& reader, version& version);
+serialization::span_reader& operator>>(serialization::span_reader& reader, transport& transport);
+serialization::span_reader& operator>>(serialization::span_reader& reader, auth_scheme& auth_scheme);
+serialization::span_reader& operator>>(serialization::span_reader& reader, auth_algorithm& auth_algorithm);
+
 }
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+
+namespace sippy::util {
+
+// a set of the values of an enum with values 0..N-1, kept as bits of one integer.
+// iterates in the order of the enum.
+template<typename E, size_t N>
+class enum_set {
+    static_assert(N <= 64);
+
+public:
+    using value_type = E;
+
+    class iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using difference_type = std::ptrdiff_t;
+        using value_type = E;
+
+        constexpr explicit iterator(const uint64_t bits) : m_bits(bits) {}
+
+        constexpr E operator*() const { return static_cast<E>(std::countr_zero(m_bits)); }
+        constexpr iterator& operator++() { m_bits &= m_bits - 1; return *this; }
+        constexpr iterator operator++(int) { iterator tmp = *this; ++(*this); return tmp; }
+
+        constexpr bool operator==(const iterator& other) const = default;
+
+    private:
+        uint64_t m_bits;
+    };
+
+    constexpr enum_set() = default;
+    constexpr enum_set(std::initializer_list<E> values);
+
+    [[nodiscard]] constexpr bool empty() const;
+    [[nodiscard]] constexpr size_t size() const;
+    [[nodiscard]] constexpr bool contains(E value) const;
+
+    constexpr void insert(E value);
+    constexpr void erase(E value);
+    constexpr void clear();
+
+    [[nodiscard]] constexpr iterator begin() const;
+    [[nodiscard]] constexpr iterator end() const;
+
+    constexpr enum_set& operator|=(enum_set other);
+    constexpr enum_set& operator&=(enum_set other);
+    constexpr enum_set& operator-=(enum_set other);
+    constexpr enum_set operator|(enum_set other) const;
+    constexpr enum_set operator&(enum_set other) const;
+    constexpr enum_set operator-(enum_set other) const;
+
+    constexpr bool operator==(const enum_set& other) const = default;
+
+private:
+    static constexpr uint64_t bit_of(E value);
+
+    uint64_t m_bits = 0;
+};
+
+template<typename E, size_t N>
+constexpr enum_set<E, N>::enum_set(const std::initializer_list<E> values) {
+    for (const auto value : values) {
+        insert(value);
+    }
+}
+
+template<typename E, size_t N>
+constexpr bool enum_set<E, N>::empty() const {
+    return m_bits == 0;
+}
+
+template<typename E, size_t N>
+constexpr size_t enum_set<E, N>::size() const {
+    return std::popcount(m_bits);
+}
+
+template<typename E, size_t N>
+constexpr bool enum_set<E, N>::contains(const E value) const {
+    return (m_bits & bit_of(value)) != 0;
+}
+
+template<typename E, size_t N>
+constexpr void enum_set<E, N>::insert(const E value) {
+    m_bits |= bit_of(value);
+}
+
+template<typename E, size_t N>
+constexpr void enum_set<E, N>::erase(const E value) {
+    m_bits &= ~bit_of(value);
+}
+
+template<typename E, size_t N>
+constexpr void enum_set<E, N>::clear() {
+    m_bits = 0;
+}
+
+template<typename E, size_t N>
+constexpr typename enum_set<E, N>::iterator enum_set<E, N>::begin() const {
+    return iterator(m_bits);
+}
+
+template<typename E, size_t N>
+constexpr typename enum_set<E, N>::iterator enum_set<E, N>::end() const {
+    return iterator(0);
+}
+
+template<typename E, size_t N>
+constexpr enum_set<E, N>& enum_set<E, N>::operator|=(const enum_set other) {
+    m_bits |= other.m_bits;
+    return *this;
+}
+
+template<typename E, size_t N>
+constexpr enum_set<E, N>& enum_set<E, N>::operator&=(const enum_set other) {
+    m_bits &= other.m_bits;
+    return *this;
+}
+
+template<typename E, size_t N>
+constexpr enum_set<E, N>& enum_set<E, N>::operator-=(const enum_set other) {
+    m_bits &= ~other.m_bits;
+    return *this;
+}
+
+template<typename E, size_t N>
+constexpr enum_set<E, N> enum_set<E, N>::operator|(const enum_set other) const {
+    auto result = *this;
+    return result |= other;
+}
+
+template<typename E, size_t N>
+constexpr enum_set<E, N> enum_set<E, N>::operator&(const enum_set other) const {
+    auto result = *this;
+    return result &= other;
+}
+
+template<typename E, size_t N>
+constexpr enum_set<E, N> enum_set<E, N>::operator-(const enum_set other) const {
+    auto result = *this;
+    return result -= other;
+}
+
+template<typename E, size_t N>
+constexpr uint64_t enum_set<E, N>::bit_of(const E value) {
+    const auto index = static_cast<size_t>(value);
+    return index < N ? uint64_t(1) << index : 0;
+}
+
+}
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+
+namespace sippy::util {
+
+// a map kept as a flat array in insertion order, holding up to N entries in place before
+// moving to the heap. meant for the few parameters of a header or attribute, where a linear
+// search is cheaper than a tree.
+template<typename K, typename V, size_t N = 4>
+class small_map {
+public:
+    using key_type = K;
+    using mapped_type = V;
+    using value_type = std::pair<K, V>;
+    using iterator = value_type*;
+    using const_iterator = const value_type*;
+
+    small_map();
+    small_map(std::initializer_list<value_type> values);
+    small_map(const small_map& other);
+    small_map(small_map&& other) noexcept;
+    ~small_map();
+
+    small_map& operator=(const small_map& other);
+    small_map& operator=(small_map&& other) noexcept;
+
+    [[nodiscard]] bool empty() const;
+    [[nodiscard]] size_t size() const;
+
+    iterator begin();
+    iterator end();
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    template<typename Key>
+    iterator find(const Key& key);
+    template<typename Key>
+    const_iterator find(const Key& key) const;
+    template<typename Key>
+    [[nodiscard]] bool contains(const Key& key) const;
+
+    // like std::map, does nothing if the key is already there
+    template<typename Key, typename Value>
+    std::pair<iterator, bool> emplace(Key&& key, Value&& value);
+    template<typename Key>
+    V& operator[](Key&& key);
+
+    template<typename Key>
+    size_t erase(const Key& key);
+    void clear();
+
+    bool operator==(const small_map& other) const;
+
+private:
+    [[nodiscard]] bool is_inline() const;
+    value_type* inline_data();
+    void reserve(size_t capacity);
+    void release();
+
+    alignas(value_type) std::byte m_inline[N * sizeof(value_type)];
+    value_type* m_data;
+    size_t m_size;
+    size_t m_capacity;
+};
+
+template<typename K, typename V, size_t N>
+small_map<K, V, N>::small_map()
+    : m_data(inline_data())
+    , m_size(0)
+    , m_capacity(N)
+{}
+
+template<typename K, typename V, size_t N>
+small_map<K, V, N>::small_map(const std::initializer_list<value_type> values)
+    : small_map() {
+    for (const auto& [key, value] : values) {
+        emplace(key, value);
+    }
+}
+
+template<typename K, typename V, size_t N>
+small_map<K, V, N>::small_map(const small_map& other)
+    : small_map() {
+    reserve(other.m_size);
+    std::uninitialized_copy(other.begin(), other.end(), m_data);
+    m_size = other.m_size;
+}
+
+template<typename K, typename V, size_t N>
+small_map<K, V, N>::small_map(small_map&& other) noexcept
+    : small_map() {
+    *this = std::move(other);
+}
+
+template<typename K, typename V, size_t N>
+small_map<K, V, N>::~small_map() {
+    release();
+}
+
+template<typename K, typename V, size_t N>
+small_map<K, V, N>& small_map<K, V, N>::operator=(const small_map& other) {
+    if (this != &other) {
+        clear();
+        reserve(other.m_size);
+        std::uninitialized_copy(other.begin(), other.end(), m_data);
+        m_size = other.m_size;
+    }
+
+    return *this;
+}
+
+template<typename K, typename V, size_t N>
+small_map<K, V, N>& small_map<K, V, N>::operator=(small_map&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    release();
+    if (other.is_inline()) {
+        std::uninitialized_move(other.begin(), other.end(), m_data);
+        m_size = other.m_size;
+        other.clear();
+    } else {
+        // take the heap array as is
+        m_data = std::exchange(other.m_data, other.inline_data());
+        m_size = std::exchange(other.m_size, 0);
+        m_capacity = std::exchange(other.m_capacity, N);
+    }
+
+    return *this;
+}
+
+template<typename K, typename V, size_t N>
+bool small_map<K, V, N>::empty() const {
+    return m_size == 0;
+}
+
+template<typename K, typename V, size_t N>
+size_t small_map<K, V, N>::size() const {
+    return m_size;
+}
+
+template<typename K, typename V, size_t N>
+typename small_map<K, V, N>::iterator small_map<K, V, N>::begin() {
+    return m_data;
+}
+
+template<typename K, typename V, size_t N>
+typename small_map<K, V, N>::iterator small_map<K, V, N>::end() {
+    return m_data + m_size;
+}
+
+template<typename K, typename V, size_t N>
+typename small_map<K, V, N>::const_iterator small_map<K, V, N>::begin() const {
+    return m_data;
+}
+
+template<typename K, typename V, size_t N>
+typename small_map<K, V, N>::const_iterator small_map<K, V, N>::end() const {
+    return m_data + m_size;
+}
+
+template<typename K, typename V, size_t N>
+template<typename Key>
+typename small_map<K, V, N>::iterator small_map<K, V, N>::find(const Key& key) {
+    return std::find_if(begin(), end(), [&key](const value_type& entry) {
+        return entry.first == key;
+    });
+}
+
+template<typename K, typename V, size_t N>
+template<typename Key>
+typename small_map<K, V, N>::const_iterator small_map<K, V, N>::find(const Key& key) const {
+    return std::find_if(begin(), end(), [&key](const value_type& entry) {
+        return entry.first == key;
+    });
+}
+
+template<typename K, typename V, size_t N>
+template<typename Key>
+bool small_map<K, V, N>::contains(const Key& key) const {
+    return find(key) != end();
+}
+
+template<typename K, typename V, size_t N>
+template<typename Key, typename Value>
+std::pair<typename small_map<K, V, N>::iterator, bool> small_map<K, V, N>::emplace(Key&& key, Value&& value) {
+    const auto it = find(key);
+    if (it != end()) {
+        return {it, false};
+    }
+
+    if (m_size == m_capacity) {
+        reserve(m_capacity * 2);
+    }
+
+    const auto entry = std::construct_at(m_data + m_size, std::forward<Key>(key), std::forward<Value>(value));
+    m_size++;
+    return {entry, true};
+}
+
+template<typename K, typename V, size_t N>
+template<typename Key>
+V& small_map<K, V, N>::operator[](Key&& key) {
+    const auto it = find(key);
+    if (it != end()) {
+        return it->second;
+    }
+
+    return emplace(std::forward<Key>(key), V()).first->second;
+}
+
+template<typename K, typename V, size_t N>
+template<typename Key>
+size_t small_map<K, V, N>::erase(const Key& key) {
+    const auto it = find(key);
+    if (it == end()) {
+        return 0;
+    }
+
+    std::move(it + 1, end(), it);
+    std::destroy_at(m_data + m_size - 1);
+    m_size--;
+    return 1;
+}
+
+template<typename K, typename V, size_t N>
+void small_map<K, V, N>::clear() {
+    std::destroy(begin(), end());
+    m_size = 0;
+}
+
+template<typename K, typename V, size_t N>
+bool small_map<K, V, N>::operator==(const small_map& other) const {
+    return std::equal(begin(), end(), other.begin(), other.end());
+}
+
+template<typename K, typename V, size_t N>
+bool small_map<K, V, N>::is_inline() const {
+    return m_data == reinterpret_cast<const value_type*>(m_inline);
+}
+
+template<typename K, typename V, size_t N>
+typename small_map<K, V, N>::value_type* small_map<K, V, N>::inline_data() {
+    return reinterpret_cast<value_type*>(m_inline);
+}
+
+template<typename K, typename V, size_t N>
+void small_map<K, V, N>::reserve(const size_t capacity) {
+    if (capacity <= m_capacity) {
+        return;
+    }
+
+    std::allocator<value_type> allocator;
+    const auto data = allocator.allocate(capacity);
+    std::uninitialized_move(begin(), end(), data);
+    std::destroy(begin(), end());
+    if (!is_inline()) {
+        allocator.deallocate(m_data, m_capacity);
+    }
+
+    m_data = data;
+    m_capacity = capacity;
+}
+
+template<typename K, typename V, size_t N>
+void small_map<K, V, N>::release() {
+    clear();
+    if (!is_inline()) {
+        std::allocator<value_type>().deallocate(m_data, m_capacity);
+        m_data = inline_data();
+        m_capacity = N;
+    }
+}
+
+}
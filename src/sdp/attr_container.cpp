@@ -28,15 +28,16 @@ void attribute_container::add(attribute_container&& other) {
 }
 
 void attribute_container::add(storage::_attribute_holder_ptr holder) {
-    _add(holder->name(), std::move(holder));
+    const std::string name = holder->name();
+    _add(name, std::move(holder));
 }
 
 attribute_container::const_iterator attribute_container::begin() const {
-    return const_iterator{m_container.begin()};
+    return const_iterator{m_container.begin(), m_container.end()};
 }
 
 attribute_container::const_iterator attribute_container::end() const {
-    return const_iterator{m_container.end()};
+    return const_iterator{m_container.end(), m_container.end()};
 }
 
 size_t attribute_container::_count(const std::string& name) const {
@@ -1,14 +1,14 @@
 
 #include <sdp/attributes.h>
 
-#include "serialization/reader.h"
+#include "serialization/span_reader.h"
+#include "util/string_helper.h"
 
 
 DEFINE_SDP_ATTRIBUTE_READ(tool) {
-    serialization::reader reader(is);
-    a.name = reader.read_until(serialization::is_whitespace);
+    a.name = reader.read_until<serialization::is_whitespace>();
     reader.eat(' ');
-    a.version = reader.read_until(serialization::is_whitespace);
+    a.version = reader.read_until<serialization::is_whitespace>();
 }
 
 DEFINE_SDP_ATTRIBUTE_WRITE(tool) {
@@ -18,7 +18,7 @@ DEFINE_SDP_ATTRIBUTE_WRITE(tool) {
 }
 
 DEFINE_SDP_ATTRIBUTE_READ(ptime) {
-    is >> a.time;
+    a.time = reader.read_number<uint64_t>();
 }
 
 DEFINE_SDP_ATTRIBUTE_WRITE(ptime) {
@@ -26,7 +26,7 @@ DEFINE_SDP_ATTRIBUTE_WRITE(ptime) {
 }
 
 DEFINE_SDP_ATTRIBUTE_READ(maxptime) {
-    is >> a.time;
+    a.time = reader.read_number<uint64_t>();
 }
 
 DEFINE_SDP_ATTRIBUTE_WRITE(maxptime) {
@@ -34,15 +34,14 @@ DEFINE_SDP_ATTRIBUTE_WRITE(maxptime) {
 }
 
 DEFINE_SDP_ATTRIBUTE_READ(rtpmap) {
-    serialization::reader reader(is);
-    is >> a.payload_type;
+    a.payload_type = reader.read_number<uint32_t>();
     reader.eat(' ');
-    a.encoding_name = reader.read_until(serialization::is_slash);
+    a.encoding_name = reader.read_until<serialization::is_slash>();
     reader.eat('/');
-    is >> a.clock_rate;
+    a.clock_rate = reader.read_number<uint32_t>();
 
-    if (reader.eat_one_if(serialization::is_slash)) {
-        is >> a.channels;
+    if (reader.eat_one_if<serialization::is_slash>()) {
+        a.channels = reader.read_number<uint8_t>();
     } else {
         a.channels = 0;
     }
@@ -57,23 +56,38 @@ DEFINE_SDP_ATTRIBUTE_WRITE(rtpmap) {
 
     if (a.channels > 1) {
         os << '/';
-        os << a.channels;
+        os << static_cast<uint32_t>(a.channels);
     }
 }
 
-DEFINE_SDP_ATTRIBUTE_READ(fmtp) {
-    serialization::reader reader(is);
-    is >> a.payload_type;
-    reader.eat(' ');
+namespace sippy::sdp::attributes {
 
-    while (true) {
-        auto name = reader.read_until(serialization::is_equal);
-        if (!reader.eat_one_if(serialization::is_equal)) {
-            break;
+static bool read_fmtp_params(const std::string_view parameters, util::small_map<std::string, std::string>& params) {
+    serialization::span_reader reader(parameters);
+    while (!reader.eof()) {
+        const auto name = util::trim_whitespace(reader.read_until<serialization::is_equal>());
+        if (name.empty() || !reader.eat_one_if<serialization::is_equal>()) {
+            return false;
         }
 
-        auto value = reader.read_until(serialization::is_colon_or_newline);
-        a.params.emplace(std::move(name), std::move(value));
+        const auto value = util::trim_whitespace(reader.read_until<serialization::is_semicolon>());
+        params.emplace(name, value);
+        reader.eat_one_if<serialization::is_semicolon>();
+    }
+
+    return true;
+}
+
+}
+
+DEFINE_SDP_ATTRIBUTE_READ(fmtp) {
+    a.payload_type = reader.read_number<uint32_t>();
+    reader.eat(' ');
+
+    const auto parameters = reader.read(reader.remaining());
+    if (!read_fmtp_params(parameters, a.params)) {
+        a.params.clear();
+        a.parameters = parameters;
     }
 }
 
@@ -81,6 +95,11 @@ DEFINE_SDP_ATTRIBUTE_WRITE(fmtp) {
     os << a.payload_type;
     os << ' ';
 
+    if (a.params.empty()) {
+        os << a.parameters;
+        return;
+    }
+
     bool first = true;
     for (const auto& [name, value] : a.params) {
         if (first) {
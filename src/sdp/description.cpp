@@ -136,7 +136,7 @@ void media_description::add_format(const uint16_t format) {
     m_formats.emplace(format, fmt_strct);
 }
 
-void media_description::add_rtpmap(const uint16_t format, const std::string_view name, const uint16_t clock_rate, const uint8_t channels) {
+void media_description::add_rtpmap(const uint16_t format, const std::string_view name, const uint32_t clock_rate, const uint8_t channels) {
     auto it = m_formats.find(format);
     if (it == m_formats.end()) {
         throw std::invalid_argument("no such format");
@@ -156,6 +156,15 @@ void media_description::add_fmtp(const uint16_t format, const std::string_view n
     it->second.params.emplace(name, value);
 }
 
+void media_description::set_fmtp(const uint16_t format, const std::string_view parameters) {
+    auto it = m_formats.find(format);
+    if (it == m_formats.end()) {
+        throw std::invalid_argument("no such format");
+    }
+
+    it->second.parameters = parameters;
+}
+
 session_description::session_description()
     : m_id()
     , m_version()
@@ -302,11 +311,11 @@ description_message session_description::to_message() const {
                 field.attributes.add(std::move(attr));
             }
 
-            if (!format.params.empty()) {
+            if (!format.params.empty() || !format.parameters.empty()) {
                 attributes::fmtp attr{};
-                for (const auto& [name, value] : format.params) {
-                    attr.params.emplace(name, value);
-                }
+                attr.payload_type = id;
+                attr.params = format.params;
+                attr.parameters = format.parameters;
                 field.attributes.add(std::move(attr));
             }
         }
@@ -425,6 +434,9 @@ void session_description::from_message(const description_message& msg) {
             for (const auto& [name, value] : it->params) {
                 desc.add_fmtp(it->payload_type, name, value);
             }
+            if (!it->parameters.empty()) {
+                desc.set_fmtp(it->payload_type, it->parameters);
+            }
         }
 
         add_media(std::move(desc));
@@ -3,6 +3,7 @@
 #include <sdp/message.h>
 
 #include "serialization/reader.h"
+#include "serialization/span_reader.h"
 #include "sip/reader.h"
 #include "util/string_helper.h"
 
@@ -23,29 +24,20 @@ static bool is_valid_string(const std::string_view str, const bool allow_whitesp
     return true;
 }
 
-static int64_t read_typed_time(std::istream& is) {
-    int64_t time;
-    is >> time;
-
-    const auto peek = is.peek();
-    if (peek == 'd' || peek == 'h' || peek == 'm' || peek == 's') {
-        char ch;
-        if (is.get(ch)) {
-            switch (ch) {
-                case 'd':
-                    time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::days(time)).count();
-                    break;
-                case 'h':
-                    time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::hours(time)).count();
-                    break;
-                case 'm':
-                    time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::minutes(time)).count();
-                    break;
-                case 's':
-                default:
-                    break;
-            }
-        }
+static int64_t read_typed_time(sippy::serialization::span_reader& reader) {
+    auto time = reader.read_number<int64_t>();
+
+    if (reader.peek('d')) {
+        reader.eat('d');
+        time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::days(time)).count();
+    } else if (reader.peek('h')) {
+        reader.eat('h');
+        time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::hours(time)).count();
+    } else if (reader.peek('m')) {
+        reader.eat('m');
+        time = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::minutes(time)).count();
+    } else if (reader.peek('s')) {
+        reader.eat('s');
     }
 
     return time;
@@ -57,7 +49,7 @@ DEFINE_SDP_FIELD_VALIDATOR(version) {
 }
 
 DEFINE_SDP_FIELD_READ(version) {
-    is >> f.ver;
+    reader >> f.ver;
 }
 
 DEFINE_SDP_FIELD_WRITE(version) {
@@ -82,16 +74,17 @@ DEFINE_SDP_FIELD_VALIDATOR(origin) {
 }
 
 DEFINE_SDP_FIELD_READ(origin) {
-    serialization::reader reader(is);
-    f.username = reader.read_until(serialization::is_whitespace);
-    f.session_id = reader.read_until(serialization::is_whitespace);
-    is >> f.session_version;
+    f.username = reader.read_until<serialization::is_whitespace>();
+    reader.eat(' ');
+    f.session_id = reader.read_until<serialization::is_whitespace>();
     reader.eat(' ');
-    is >> f.net_type;
+    f.session_version = reader.read_number<uint64_t>();
     reader.eat(' ');
-    is >> f.addr_type;
+    reader >> f.net_type;
     reader.eat(' ');
-    f.unicast_address = reader.read_until(serialization::is_new_line);
+    reader >> f.addr_type;
+    reader.eat(' ');
+    f.unicast_address = reader.read_until<serialization::is_new_line>();
 }
 
 DEFINE_SDP_FIELD_WRITE(origin) {
@@ -113,7 +106,7 @@ DEFINE_SDP_FIELD_VALIDATOR(session_name) {
 }
 
 DEFINE_SDP_FIELD_READ(session_name) {
-    is >> f.name;
+    f.name = reader.read_until<serialization::is_new_line>();
 }
 
 DEFINE_SDP_FIELD_WRITE(session_name) {
@@ -125,7 +118,7 @@ DEFINE_SDP_FIELD_VALIDATOR(session_information) {
 }
 
 DEFINE_SDP_FIELD_READ(session_information) {
-    is >> f.information;
+    f.information = reader.read_until<serialization::is_new_line>();
 }
 
 DEFINE_SDP_FIELD_WRITE(session_information) {
@@ -138,7 +131,7 @@ DEFINE_SDP_FIELD_VALIDATOR(uri) {
 }
 
 DEFINE_SDP_FIELD_READ(uri) {
-    is >> f.uri_str;
+    f.uri_str = reader.read_until<serialization::is_new_line>();
 }
 
 DEFINE_SDP_FIELD_WRITE(uri) {
@@ -161,8 +154,7 @@ DEFINE_SDP_FIELD_READ(email) {
     static const auto regex1 = R"(^(?:[\w\d\s._-]+\s)<?([\w\d._]+@[\w]+\.[\w\d]+)>?$)";
     static const auto regex2 = R"(^([\w\d._]+@[\w]+\.[\w\d]+)(?:\s\([\w\d\s._-]+\))$)";
 
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
+    const auto str = std::string(reader.read_until<serialization::is_new_line>());
 
     auto match_opt = serialization::try_parse(str, regex1);
     if (match_opt) {
@@ -175,7 +167,13 @@ DEFINE_SDP_FIELD_READ(email) {
 
         f.email_address = match[2].str();
     } else {
-        const auto match = serialization::parse(str, regex2);
+        match_opt = serialization::try_parse(str, regex2);
+        if (!match_opt) {
+            reader.fail(serialization::read_error::invalid_value);
+            return;
+        }
+
+        const auto& match = match_opt.value();
         if (match[1].matched) {
             f.display_name = match[1].str();
         } else {
@@ -213,11 +211,10 @@ DEFINE_SDP_FIELD_VALIDATOR(phone_number) {
 }
 
 DEFINE_SDP_FIELD_READ(phone_number) {
-    static const auto regex1 = R"(^(?:[\w\d\s._-]+\s)<?(+?[\w\d._]+)>?$)";
-    static const auto regex2 = R"(^(+?[\w\d._]+)(?:\s\([\w\d\s._-]+\))$)";
+    static const auto regex1 = R"(^(?:[\w\d\s._-]+\s)<?(\+?[\w\d._]+)>?$)";
+    static const auto regex2 = R"(^(\+?[\w\d._]+)(?:\s\([\w\d\s._-]+\))$)";
 
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
+    const auto str = std::string(reader.read_until<serialization::is_new_line>());
 
     auto match_opt = serialization::try_parse(str, regex1);
     if (match_opt) {
@@ -230,7 +227,13 @@ DEFINE_SDP_FIELD_READ(phone_number) {
 
         f.number = match[2].str();
     } else {
-        const auto match = serialization::parse(str, regex2);
+        match_opt = serialization::try_parse(str, regex2);
+        if (!match_opt) {
+            reader.fail(serialization::read_error::invalid_value);
+            return;
+        }
+
+        const auto& match = match_opt.value();
         if (match[1].matched) {
             f.display_name = match[1].str();
         } else {
@@ -266,21 +269,18 @@ DEFINE_SDP_FIELD_VALIDATOR(connection_information) {
 }
 
 DEFINE_SDP_FIELD_READ(connection_information) {
-    serialization::reader reader(is);
-
-    is >> f.net_type;
+    reader >> f.net_type;
     reader.eat(' ');
-    is >> f.addr_type;
+    reader >> f.addr_type;
     reader.eat(' ');
-    f.base_address = reader.read_until(serialization::is_slash_or_new_line);
+    f.base_address = reader.read_until<serialization::is_slash_or_new_line>();
 
     const auto expect_ttl = f.addr_type == address_type::ipv4;
     f.ttl = std::nullopt;
     f.num_of_addresses = std::nullopt;
 
-    if (reader.eat_one_if(serialization::is_slash)) {
-        uint16_t num;
-        is >> num;
+    if (reader.eat_one_if<serialization::is_slash>()) {
+        const auto num = reader.read_number<uint16_t>();
 
         if (expect_ttl) {
             f.ttl = num;
@@ -288,10 +288,8 @@ DEFINE_SDP_FIELD_READ(connection_information) {
             f.num_of_addresses = num;
         }
     }
-    if (expect_ttl && reader.eat_one_if(serialization::is_slash)) {
-        uint16_t num;
-        is >> num;
-        f.num_of_addresses = num;
+    if (expect_ttl && reader.eat_one_if<serialization::is_slash>()) {
+        f.num_of_addresses = reader.read_number<uint16_t>();
     }
 }
 
@@ -318,10 +316,9 @@ DEFINE_SDP_FIELD_VALIDATOR(bandwidth_information) {
 }
 
 DEFINE_SDP_FIELD_READ(bandwidth_information) {
-    serialization::reader reader(is);
-    f.bw_type = reader.read_until(serialization::is_colon);
+    f.bw_type = reader.read_until<serialization::is_colon>();
     reader.eat(':');
-    f.bandwidth = reader.read_until(serialization::is_new_line);
+    f.bandwidth = reader.read_until<serialization::is_new_line>();
 }
 
 DEFINE_SDP_FIELD_WRITE(bandwidth_information) {
@@ -336,10 +333,9 @@ DEFINE_SDP_FIELD_VALIDATOR(time_active) {
 }
 
 DEFINE_SDP_FIELD_READ(time_active) {
-    serialization::reader reader(is);
-    is >> f.start_time;
+    f.start_time = reader.read_number<uint64_t>();
     reader.eat(' ');
-    is >> f.stop_time;
+    f.stop_time = reader.read_number<uint64_t>();
 }
 
 DEFINE_SDP_FIELD_WRITE(time_active) {
@@ -354,13 +350,12 @@ DEFINE_SDP_FIELD_VALIDATOR(repeat_times) {
 }
 
 DEFINE_SDP_FIELD_READ(repeat_times) {
-    serialization::reader reader(is);
-    is >> f.repeat_interval;
+    f.repeat_interval = read_typed_time(reader);
     reader.eat(' ');
-    f.active_duration = read_typed_time(is);
+    f.active_duration = read_typed_time(reader);
 
-    while (reader.eat_one_if(serialization::is_whitespace)) {
-        f.offsets.push_back(read_typed_time(is));
+    while (reader.eat_one_if<serialization::is_whitespace>()) {
+        f.offsets.push_back(read_typed_time(reader));
     }
 }
 
@@ -382,15 +377,15 @@ DEFINE_SDP_FIELD_VALIDATOR(timezone) {
     return true;
 }
 
-static sippy::sdp::fields::timezone_adjustment read_timezone_adjustment(std::istream& is, sippy::serialization::reader& reader) {
+static sippy::sdp::fields::timezone_adjustment read_timezone_adjustment(sippy::serialization::span_reader& reader) {
     using namespace sippy;
 
     sdp::fields::timezone_adjustment adjustment{};
-    is >> adjustment.adjustment_time;
+    adjustment.adjustment_time = reader.read_number<uint64_t>();
     reader.eat(' ');
 
-    const auto negative = reader.eat_one_if(serialization::is_dash);
-    adjustment.offset = read_typed_time(is);
+    const auto negative = reader.eat_one_if<serialization::is_dash>();
+    adjustment.offset = read_typed_time(reader);
     if (negative) {
         adjustment.offset = -adjustment.offset;
     }
@@ -399,12 +394,10 @@ static sippy::sdp::fields::timezone_adjustment read_timezone_adjustment(std::ist
 }
 
 DEFINE_SDP_FIELD_READ(timezone) {
-    serialization::reader reader(is);
-
     // must have one
     do {
-        f.adjustments.push_back(read_timezone_adjustment(is, reader));
-    } while (reader.read_one_if(serialization::is_whitespace));
+        f.adjustments.push_back(read_timezone_adjustment(reader));
+    } while (reader.eat_one_if<serialization::is_whitespace>());
 }
 
 DEFINE_SDP_FIELD_WRITE(timezone) {
@@ -425,22 +418,19 @@ DEFINE_SDP_FIELD_VALIDATOR(media_description) {
 }
 
 DEFINE_SDP_FIELD_READ(media_description) {
-    serialization::reader reader(is);
-    is >> f.media_type;
+    reader >> f.media_type;
     reader.eat(' ');
 
-    is >> f.port;
-    if (reader.eat_one_if(serialization::is_slash)) {
-        is >> f.number_of_ports;
+    f.port = reader.read_number<uint16_t>();
+    if (reader.eat_one_if<serialization::is_slash>()) {
+        f.number_of_ports = reader.read_number<uint64_t>();
     }
     reader.eat(' ');
 
-    is >> f.protocol;
+    reader >> f.protocol;
 
-    while (reader.eat_one_if(serialization::is_whitespace)) {
-        uint16_t format;
-        is >> format;
-        f.formats.push_back(format);
+    while (reader.eat_one_if<serialization::is_whitespace>()) {
+        f.formats.push_back(reader.read_number<uint16_t>());
     }
 }
 
@@ -455,12 +445,7 @@ DEFINE_SDP_FIELD_WRITE(media_description) {
     os << ' ';
     os << f.protocol;
 
-    for (auto it = f.formats.cbegin(); it != f.formats.cend(); ) {
-        os << *it;
-
-        ++it;
-        if (it != f.formats.cend()) {
-            os << ' ';
-        }
+    for (const auto format : f.formats) {
+        os << ' ' << format;
     }
 }
@@ -7,6 +7,41 @@
 
 namespace sippy::sdp {
 
+parse_exception::parse_exception(parse_error error)
+    : m_error(std::move(error))
+{}
+
+const parse_error& parse_exception::error() const {
+    return m_error;
+}
+
+const char* parse_exception::what() const noexcept {
+    return parse_error_str(m_error.code);
+}
+
+const char* parse_error_str(const parse_error_code code) {
+    switch (code) {
+        case parse_error_code::unexpected_character:
+            return "unexpected character";
+        case parse_error_code::not_enough_characters:
+            return "not enough characters";
+        case parse_error_code::bad_number:
+            return "bad number";
+        case parse_error_code::unknown_value:
+            return "unknown value";
+        case parse_error_code::invalid_value:
+            return "invalid value";
+        case parse_error_code::missing_field:
+            return "missing required field";
+        case parse_error_code::field_trailing_data:
+            return "trailing data in field";
+        case parse_error_code::invalid_message:
+            return "invalid message";
+        default:
+            return "unknown parse error";
+    }
+}
+
 template<typename T>
 static bool is_valid_opt(const std::optional<T>& opt) {
     return !opt.has_value() || fields::meta::_field_validator<T>::validate(opt.value());
@@ -23,93 +58,110 @@ static bool is_valid_vec(const std::vector<T>& vec) {
     return true;
 }
 
-void validate_message(const description_message& message) {
+const char* find_invalid_field(const description_message& message) {
     if (!fields::meta::_field_validator<fields::version>::validate(message.version)) {
-        throw std::invalid_argument("Invalid version field");
+        return "Invalid version field";
     }
     if (!fields::meta::_field_validator<fields::origin>::validate(message.origin)) {
-        throw std::invalid_argument("Invalid origin field");
+        return "Invalid origin field";
     }
     if (!fields::meta::_field_validator<fields::session_name>::validate(message.name)) {
-        throw std::invalid_argument("Invalid session name field");
+        return "Invalid session name field";
     }
     if (!is_valid_opt(message.information)) {
-        throw std::invalid_argument("Invalid session level information field");
+        return "Invalid session level information field";
     }
     if (!is_valid_opt(message.uri)) {
-        throw std::invalid_argument("Invalid session level uri field");
+        return "Invalid session level uri field";
     }
     if (!is_valid_vec(message.emails)) {
-        throw std::invalid_argument("Invalid session level emails field");
+        return "Invalid session level emails field";
     }
     if (!is_valid_vec(message.phone_numbers)) {
-        throw std::invalid_argument("Invalid session level phone numbers field");
+        return "Invalid session level phone numbers field";
     }
     if (!is_valid_opt(message.connection_information)) {
-        throw std::invalid_argument("Invalid session level connection info field");
+        return "Invalid session level connection info field";
     }
     if (!is_valid_vec(message.bandwidths)) {
-        throw std::invalid_argument("Invalid session level bandwiths field");
+        return "Invalid session level bandwiths field";
     }
 
     for (const auto& attr : message.attributes) {
         if ((attr.flags() & attributes::flag_session_level) == 0) {
-            throw std::invalid_argument("Invalid attribute in session level");
+            return "Invalid attribute in session level";
         }
         if (message.attributes.count(attr.name()) > 1 && (attr.flags() & attributes::flag_allow_multiple) == 0) {
-            throw std::invalid_argument("Attribute has multiple entries but only one allowed");
+            return "Attribute has multiple entries but only one allowed";
         }
     }
 
     for (const auto& time_desc : message.time_descriptions) {
         if (!fields::meta::_field_validator<fields::time_active>::validate(time_desc.times)) {
-            throw std::invalid_argument("Invalid times field");
+            return "Invalid times field";
         }
 
         for (const auto& repeat_desc : time_desc.repeat) {
             if (!fields::meta::_field_validator<fields::repeat_times>::validate(repeat_desc.repeat)) {
-                throw std::invalid_argument("Invalid repeat field");
+                return "Invalid repeat field";
             }
             if (!is_valid_opt(repeat_desc.timezone)) {
-                throw std::invalid_argument("Invalid timezone field");
+                return "Invalid timezone field";
             }
         }
     }
 
     for (const auto& media_desc : message.media_descriptions) {
         if (!fields::meta::_field_validator<fields::media_description>::validate(media_desc.media)) {
-            throw std::invalid_argument("Invalid media level media field");
+            return "Invalid media level media field";
         }
         if (!is_valid_opt(media_desc.information)) {
-            throw std::invalid_argument("Invalid media level information field");
+            return "Invalid media level information field";
         }
         if (!is_valid_vec(media_desc.connections)) {
-            throw std::invalid_argument("Invalid media level connections field");
+            return "Invalid media level connections field";
         }
         if (!is_valid_vec(media_desc.bandwidths)) {
-            throw std::invalid_argument("Invalid media level bandwidths field");
+            return "Invalid media level bandwidths field";
         }
 
         for (const auto& attr : media_desc.attributes) {
             if ((attr.flags() & attributes::flag_media_level) == 0) {
-                throw std::invalid_argument("Invalid attribute in media level");
+                return "Invalid attribute in media level";
             }
             if (media_desc.attributes.count(attr.name()) > 1 && (attr.flags() & attributes::flag_allow_multiple) == 0) {
-                throw std::invalid_argument("Attribute has multiple entries but only one allowed");
+                return "Attribute has multiple entries but only one allowed";
             }
         }
     }
+
+    return nullptr;
+}
+
+void validate_message(const description_message& message) {
+    const auto error = find_invalid_field(message);
+    if (error != nullptr) {
+        throw std::invalid_argument(error);
+    }
 }
 
 description_message parse(std::istream& is) {
-    reader reader(is);
-    return reader.read();
+    const std::string data{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+    return parse({reinterpret_cast<const uint8_t*>(data.data()), data.size()});
 }
 
 description_message parse(const std::span<const uint8_t> buffer) {
-    util::istream_buff buff(buffer);
-    std::istream is(&buff);
-    return parse(is);
+    auto result = try_parse(buffer);
+    if (!result) {
+        throw parse_exception(std::move(result.error()));
+    }
+
+    return std::move(result.value());
+}
+
+std::expected<description_message, parse_error> try_parse(const std::span<const uint8_t> buffer) {
+    reader reader(buffer);
+    return reader.read();
 }
 
 void write(std::ostream& os, const description_message& message) {
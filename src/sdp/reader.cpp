@@ -5,16 +5,34 @@
 
 namespace sippy::sdp {
 
-reader::reader(std::istream &is)
-    : m_is(is)
-    , m_reader(is)
+static parse_error_code to_parse_error_code(const serialization::read_error error) {
+    switch (error) {
+        case serialization::read_error::unexpected_character:
+            return parse_error_code::unexpected_character;
+        case serialization::read_error::not_enough_characters:
+            return parse_error_code::not_enough_characters;
+        case serialization::read_error::bad_number:
+            return parse_error_code::bad_number;
+        case serialization::read_error::unknown_value:
+            return parse_error_code::unknown_value;
+        case serialization::read_error::invalid_value:
+        default:
+            return parse_error_code::invalid_value;
+    }
+}
+
+reader::reader(const std::span<const uint8_t> buffer)
+    : m_buffer(reinterpret_cast<const char*>(buffer.data()))
+    , m_reader(buffer)
+    , m_error()
 {}
 
-description_message reader::read() {
+std::expected<description_message, parse_error> reader::read() {
     description_message description{};
 
     read(description.version);
     read(description.origin);
+    read(description.name);
     read_optional(description.information);
     read_optional(description.uri);
     read_vector(description.emails);
@@ -36,7 +54,14 @@ description_message reader::read() {
         description.media_descriptions.push_back(std::move(media_description));
     };
 
-    validate_message(description);
+    if (failed()) {
+        return std::unexpected(std::move(m_error.value()));
+    }
+
+    const auto invalid = find_invalid_field(description);
+    if (invalid != nullptr) {
+        return std::unexpected(parse_error{parse_error_code::invalid_message, m_reader.position(), {}});
+    }
 
     return description;
 }
@@ -64,33 +89,62 @@ void reader::read_description(message_media_description& description) {
     read_attributes(description.attributes);
 }
 
+std::string_view reader::read_line() {
+    const auto line = m_reader.read_until_any("\r\n");
+
+    // be lenient with bare LF line endings and a missing final line break
+    m_reader.eat_one_if<serialization::is_carriage_return>();
+    if (!m_reader.eof()) {
+        m_reader.eat('\n');
+    }
+
+    return line;
+}
+
+bool reader::failed() {
+    if (!m_error && m_reader.failed()) {
+        fail(m_reader, {});
+    }
+
+    return m_error.has_value();
+}
+
+void reader::fail(const parse_error_code code, const size_t offset, std::string field) {
+    if (!m_error) {
+        m_error = parse_error{code, offset, std::move(field)};
+    }
+}
+
+void reader::fail(const serialization::span_reader& reader, std::string field) {
+    fail(to_parse_error_code(reader.error()), reader.error_location() - m_buffer, std::move(field));
+}
+
 bool reader::peek_attribute() {
-    return m_reader.peek(fields::field_name_attribute);
+    return !failed() && m_reader.peek(fields::field_name_attribute);
 }
 
 attributes::storage::_attribute_holder_ptr reader::read_attribute() {
+    m_reader.eat(fields::field_name_attribute);
     m_reader.eat('=');
 
     attributes::storage::_attribute_holder_ptr ptr;
 
-    auto value = m_reader.read_until(serialization::is_colon_or_newline);
-    if (m_reader.eat_one_if(serialization::is_colon)) {
-        auto name = std::move(value);
-        value = m_reader.read_until(serialization::is_new_line);
-
+    serialization::span_reader line_reader(read_line());
+    const auto name = line_reader.read_until<serialization::is_colon>();
+    if (line_reader.eat_one_if<serialization::is_colon>()) {
         const auto def = attributes::storage::get_attribute(name);
-        if (def) {
-            ptr = def.value()->create();
-            std::stringstream ss(value);
-            ptr->operator>>(ss);
+        if (def != nullptr) {
+            ptr = def->create();
+            ptr->operator>>(line_reader);
+            if (line_reader.failed()) {
+                fail(line_reader, std::string(name));
+                return nullptr;
+            }
         }
     } else {
         // todo: HANDLE
     }
 
-    m_reader.eat('\r');
-    m_reader.eat('\n');
-
     return ptr;
 }
 
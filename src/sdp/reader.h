@@ -2,42 +2,52 @@
 
 #include <sdp/message.h>
 
-#include "serialization/reader.h"
+#include "serialization/span_reader.h"
 
 namespace sippy::sdp {
 
 class reader {
 public:
-    explicit reader(std::istream& is);
-    description_message read();
+    explicit reader(std::span<const uint8_t> buffer);
+    std::expected<description_message, parse_error> read();
 
 private:
     template<fields::meta::_field_type T>
     bool peek() {
         const auto expected_name = fields::meta::_field_detail<T>::name();
-        return m_reader.peek(expected_name);
+        return !failed() && m_reader.peek(expected_name);
     }
 
     template<typename T>
     bool read_next_field(T& field) {
-        if (peek<T>()) {
+        if (!peek<T>()) {
             return false;
         }
 
         const auto expected_name = fields::meta::_field_detail<T>::name();
         m_reader.eat(expected_name);
-
         m_reader.eat('=');
-        m_is >> field;
-        m_reader.eat('\r');
-        m_reader.eat('\n');
+
+        const auto line = read_line();
+        serialization::span_reader line_reader(line);
+        line_reader >> field;
+        if (line_reader.failed()) {
+            fail(line_reader, std::string(1, expected_name));
+            return false;
+        }
+        if (!line_reader.eof()) {
+            const auto offset = static_cast<size_t>(line.data() - m_buffer) + line_reader.position();
+            fail(parse_error_code::field_trailing_data, offset, std::string(1, expected_name));
+            return false;
+        }
 
         return true;
     }
     template<typename T>
     void read(T& field) {
-        if (!read_next_field(field)) {
-            throw std::runtime_error("Missing required field");
+        if (!read_next_field(field) && !failed()) {
+            const auto expected_name = fields::meta::_field_detail<T>::name();
+            fail(parse_error_code::missing_field, m_reader.position(), std::string(1, expected_name));
         }
     }
     template<typename T>
@@ -63,12 +73,19 @@ private:
     void read_description(media_time_description& description);
     void read_description(message_media_description& description);
 
+    std::string_view read_line();
+
+    bool failed();
+    void fail(parse_error_code code, size_t offset, std::string field);
+    void fail(const serialization::span_reader& reader, std::string field);
+
     bool peek_attribute();
     attributes::storage::_attribute_holder_ptr read_attribute();
     void read_attributes(attributes::attribute_container& attributes);
 
-    std::istream& m_is;
-    serialization::reader m_reader;
+    const char* m_buffer;
+    serialization::span_reader m_reader;
+    std::optional<parse_error> m_error;
 };
 
 }
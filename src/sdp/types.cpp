@@ -1,10 +1,11 @@
 
-#include <map>
 #include <cstdint>
 
 #include <sdp/types.h>
 
+#include "serialization/enum_codec.h"
 #include "serialization/reader.h"
+#include "serialization/span_reader.h"
 
 namespace sippy::sdp {
 
@@ -50,36 +51,36 @@ public:
     }
 };
 
-std::map<std::string, media_type, std::less<>> m_str_to_media_type = {
-    {"audio", media_type::audio},
-    {"video", media_type::video},
-    {"application", media_type::application},
-    {"text", media_type::text},
-    {"message", media_type::message},
-};
-
-std::map<std::string, transport_protocol, std::less<>> m_str_to_transport_proto = {
-    {"UDP", transport_protocol::udp},
-    {"RTP/AVP", transport_protocol::rtp_avp},
-    {"RTP/SAVP", transport_protocol::rtp_savp},
-    {"RTP/SAVPF", transport_protocol::rtp_savpf}
-};
-
-std::map<std::string, network_type, std::less<>> m_str_to_net_type = {
-    {"IN", network_type::in},
-};
-
-std::map<std::string, address_type, std::less<>> m_str_to_addr_type = {
-    {"IP4", address_type::ipv4},
-    {"IP6", address_type::ipv6},
-};
-
-std::map<std::string, media_direction, std::less<>> m_str_to_media_direction = {
-    {"recvonly", media_direction::recvonly},
-    {"sendrecv", media_direction::sendrecv},
-    {"sendonly", media_direction::sendonly},
-    {"inactive", media_direction::inactive},
-};
+static constexpr auto media_type_codec = serialization::make_enum_codec<media_type>({
+    "audio",
+    "video",
+    "text",
+    "application",
+    "message",
+});
+
+static constexpr auto transport_proto_codec = serialization::make_enum_codec<transport_protocol>({
+    "UDP",
+    "RTP/AVP",
+    "RTP/SAVP",
+    "RTP/SAVPF"
+});
+
+static constexpr auto net_type_codec = serialization::make_enum_codec<network_type>({
+    "IN",
+});
+
+static constexpr auto addr_type_codec = serialization::make_enum_codec<address_type>({
+    "IP4",
+    "IP6",
+});
+
+static constexpr auto media_direction_codec = serialization::make_enum_codec<media_direction>({
+    "recvonly",
+    "sendrecv",
+    "sendonly",
+    "inactive",
+});
 
 std::istream& operator>>(std::istream& is, version& version) {
     uint16_t i;
@@ -110,9 +111,9 @@ std::istream& operator>>(std::istream& is, media_type& media_type) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter);
 
-    const auto it = m_str_to_media_type.find(line);
-    if (it != m_str_to_media_type.end()) {
-        media_type = it->second;
+    const auto value = media_type_codec.decode(line);
+    if (value.has_value()) {
+        media_type = value.value();
     } else {
         throw unknown_media_type();
     }
@@ -121,26 +122,12 @@ std::istream& operator>>(std::istream& is, media_type& media_type) {
 }
 
 std::ostream& operator<<(std::ostream& os, const media_type media_type) {
-    switch (media_type) {
-        case media_type::audio:
-            os << "audio";
-            break;
-        case media_type::video:
-            os << "video";
-            break;
-        case media_type::text:
-            os << "text";
-            break;
-        case media_type::application:
-            os << "application";
-            break;
-        case media_type::message:
-            os << "message";
-            break;
-        default:
-            throw unknown_media_type();
+    const auto str = media_type_codec.encode(media_type);
+    if (str.empty()) {
+        throw unknown_media_type();
     }
 
+    os << str;
     return os;
 }
 
@@ -148,9 +135,9 @@ std::istream& operator>>(std::istream& is, transport_protocol& transport_protoco
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter_or_slash);
 
-    const auto it = m_str_to_transport_proto.find(line);
-    if (it != m_str_to_transport_proto.end()) {
-        transport_protocol = it->second;
+    const auto value = transport_proto_codec.decode(line);
+    if (value.has_value()) {
+        transport_protocol = value.value();
     } else {
         throw unknown_transport_protocol();
     }
@@ -159,23 +146,12 @@ std::istream& operator>>(std::istream& is, transport_protocol& transport_protoco
 }
 
 std::ostream& operator<<(std::ostream& os, const transport_protocol transport_protocol) {
-    switch (transport_protocol) {
-        case transport_protocol::udp:
-            os << "UDP";
-            break;
-        case transport_protocol::rtp_avp:
-            os << "RTP/AVP";
-            break;
-        case transport_protocol::rtp_savp:
-            os << "RTP/SAVP";
-            break;
-        case transport_protocol::rtp_savpf:
-            os << "RTP/SAVPF";
-            break;
-        default:
-            throw unknown_transport_protocol();
+    const auto str = transport_proto_codec.encode(transport_protocol);
+    if (str.empty()) {
+        throw unknown_transport_protocol();
     }
 
+    os << str;
     return os;
 }
 
@@ -183,9 +159,9 @@ std::istream& operator>>(std::istream& is, network_type& network_type) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter_or_slash);
 
-    const auto it = m_str_to_net_type.find(line);
-    if (it != m_str_to_net_type.end()) {
-        network_type = it->second;
+    const auto value = net_type_codec.decode(line);
+    if (value.has_value()) {
+        network_type = value.value();
     } else {
         throw unknown_network_type();
     }
@@ -194,14 +170,12 @@ std::istream& operator>>(std::istream& is, network_type& network_type) {
 }
 
 std::ostream& operator<<(std::ostream& os, const network_type network_type) {
-    switch (network_type) {
-        case network_type::in:
-            os << "IN";
-            break;
-        default:
-            throw unknown_network_type();
+    const auto str = net_type_codec.encode(network_type);
+    if (str.empty()) {
+        throw unknown_network_type();
     }
 
+    os << str;
     return os;
 }
 
@@ -209,9 +183,9 @@ std::istream& operator>>(std::istream& is, address_type& address_type) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter_or_slash);
 
-    const auto it = m_str_to_addr_type.find(line);
-    if (it != m_str_to_addr_type.end()) {
-        address_type = it->second;
+    const auto value = addr_type_codec.decode(line);
+    if (value.has_value()) {
+        address_type = value.value();
     } else {
         throw unknown_address_type();
     }
@@ -220,17 +194,12 @@ std::istream& operator>>(std::istream& is, address_type& address_type) {
 }
 
 std::ostream& operator<<(std::ostream& os, const address_type address_type) {
-    switch (address_type) {
-        case address_type::ipv4:
-            os << "IP4";
-            break;
-        case address_type::ipv6:
-            os << "IP6";
-            break;
-        default:
-            throw unknown_address_type();
+    const auto str = addr_type_codec.encode(address_type);
+    if (str.empty()) {
+        throw unknown_address_type();
     }
 
+    os << str;
     return os;
 }
 
@@ -238,9 +207,9 @@ std::istream& operator>>(std::istream& is, media_direction& media_direction) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter);
 
-    const auto it = m_str_to_media_direction.find(line);
-    if (it != m_str_to_media_direction.end()) {
-        media_direction = it->second;
+    const auto value = media_direction_codec.decode(line);
+    if (value.has_value()) {
+        media_direction = value.value();
     } else {
         throw unknown_media_direction();
     }
@@ -249,24 +218,90 @@ std::istream& operator>>(std::istream& is, media_direction& media_direction) {
 }
 
 std::ostream& operator<<(std::ostream& os, const media_direction media_direction) {
-    switch (media_direction) {
-        case media_direction::recvonly:
-            os << "recvonly";
-            break;
-        case media_direction::sendrecv:
-            os << "sendrecv";
-            break;
-        case media_direction::sendonly:
-            os << "sendonly";
-            break;
-        case media_direction::inactive:
-            os << "inactive";
+    const auto str = media_direction_codec.encode(media_direction);
+    if (str.empty()) {
+        throw unknown_media_direction();
+    }
+
+    os << str;
+    return os;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, version& version) {
+    switch (reader.read_number<uint16_t>()) {
+        case 0:
+            version = version::version_0;
             break;
         default:
-            throw unknown_media_direction();
+            reader.fail(serialization::read_error::unknown_value);
     }
 
-    return os;
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, media_type& media_type) {
+    const auto str = reader.read_while<serialization::is_letter>();
+
+    const auto value = media_type_codec.decode(str);
+    if (value.has_value()) {
+        media_type = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, transport_protocol& transport_protocol) {
+    const auto str = reader.read_while<serialization::is_letter_or_slash>();
+
+    const auto value = transport_proto_codec.decode(str);
+    if (value.has_value()) {
+        transport_protocol = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, network_type& network_type) {
+    const auto str = reader.read_while<serialization::is_letter>();
+
+    const auto value = net_type_codec.decode(str);
+    if (value.has_value()) {
+        network_type = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, address_type& address_type) {
+    const auto str = reader.read_while<serialization::is_alphanumeric>();
+
+    const auto value = addr_type_codec.decode(str);
+    if (value.has_value()) {
+        address_type = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, media_direction& media_direction) {
+    const auto str = reader.read_while<serialization::is_letter>();
+
+    const auto value = media_direction_codec.decode(str);
+    if (value.has_value()) {
+        media_direction = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
 }
 
 }
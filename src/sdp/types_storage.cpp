@@ -1,32 +1,45 @@
 
-#include <unordered_map>
+#include <array>
+#include <map>
 
 #include "types_storage.h"
 
 namespace sippy::sdp::attributes::storage {
 
-static std::unordered_map<std::string, std::shared_ptr<_base_attribute_def>>& _get_storage() {
-    static std::unordered_map<std::string, std::shared_ptr<_base_attribute_def>> _headers;
-    return _headers;
+// definitions of the built-in types, constant initialized so lookups never touch a refcount
+template<meta::_attribute_type T>
+static const _attribute_def<T> _known_def{};
+
+static constexpr std::array<const _base_attribute_def*, 5> _known_defs = {
+    &_known_def<tool>,
+    &_known_def<ptime>,
+    &_known_def<maxptime>,
+    &_known_def<rtpmap>,
+    &_known_def<fmtp>,
+};
+
+// attributes registered at runtime, for types declared outside the library
+static std::map<std::string, std::shared_ptr<_base_attribute_def>, std::less<>>& _get_storage() {
+    static std::map<std::string, std::shared_ptr<_base_attribute_def>, std::less<>> _attributes;
+    return _attributes;
 }
 
 void _register_attribute_internal(const std::string& name, std::shared_ptr<_base_attribute_def> ptr) {
     _get_storage()[name] = std::move(ptr);
 }
 
-std::optional<std::shared_ptr<_base_attribute_def>> get_attribute(const std::string& name) {
+const _base_attribute_def* get_attribute(const std::string_view name) {
+    for (const auto def : _known_defs) {
+        if (name == def->name()) {
+            return def;
+        }
+    }
+
     const auto it = _get_storage().find(name);
     if (it != _get_storage().end()) {
-        return it->second;
+        return it->second.get();
     }
-    return std::nullopt;
-}
-
-void __attribute__((constructor)) register_known_types() {
-    register_attribute<tool>();
-    register_attribute<ptime>();
-    register_attribute<maxptime>();
-    register_attribute<rtpmap>();
+    return nullptr;
 }
 
 }
@@ -8,6 +8,7 @@
 
 namespace sippy::sdp::attributes::storage {
 
-std::optional<std::shared_ptr<_base_attribute_def>> get_attribute(const std::string& name);
+// nullptr if the attribute is unknown
+const _base_attribute_def* get_attribute(std::string_view name);
 
 }
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace sippy::serialization {
+
+// maps the names of an enum with values 0..N-1 to and from strings.
+// decoding hashes the length and first, second and last characters into a table which is
+// searched at compile time for a multiplier with no collisions, then confirms with one compare.
+template<typename E, size_t N>
+class enum_codec {
+public:
+    consteval explicit enum_codec(const std::array<std::string_view, N>& names);
+
+    [[nodiscard]] constexpr std::optional<E> decode(std::string_view str) const;
+    // empty for values outside the enum
+    [[nodiscard]] constexpr std::string_view encode(E value) const;
+
+private:
+    static constexpr size_t table_bits = std::bit_width(N * 2);
+    static constexpr size_t table_size = size_t(1) << table_bits;
+
+    static constexpr uint32_t key_of(std::string_view str);
+    static constexpr size_t slot_of(uint32_t key, uint32_t multiplier);
+
+    std::array<std::string_view, N> m_names;
+    std::array<int8_t, table_size> m_slots;
+    uint32_t m_multiplier;
+};
+
+template<typename E, size_t N>
+consteval enum_codec<E, N> make_enum_codec(const std::string_view (&names)[N]) {
+    std::array<std::string_view, N> array{};
+    for (size_t i = 0; i < N; i++) {
+        array[i] = names[i];
+    }
+
+    return enum_codec<E, N>(array);
+}
+
+template<typename E, size_t N>
+consteval enum_codec<E, N>::enum_codec(const std::array<std::string_view, N>& names)
+    : m_names(names)
+    , m_slots()
+    , m_multiplier(0) {
+    static_assert(N < 128);
+
+    for (uint32_t multiplier = 0x9e3779b1u; ; multiplier += 2) {
+        m_slots.fill(-1);
+
+        bool collision = false;
+        for (size_t i = 0; i < N && !collision; i++) {
+            auto& slot = m_slots[slot_of(key_of(names[i]), multiplier)];
+            collision = slot >= 0;
+            slot = static_cast<int8_t>(i);
+        }
+
+        if (!collision) {
+            m_multiplier = multiplier;
+            break;
+        }
+    }
+}
+
+template<typename E, size_t N>
+constexpr std::optional<E> enum_codec<E, N>::decode(const std::string_view str) const {
+    if (str.empty()) {
+        return std::nullopt;
+    }
+
+    const auto index = m_slots[slot_of(key_of(str), m_multiplier)];
+    if (index < 0 || m_names[index] != str) {
+        return std::nullopt;
+    }
+
+    return static_cast<E>(index);
+}
+
+template<typename E, size_t N>
+constexpr std::string_view enum_codec<E, N>::encode(const E value) const {
+    const auto index = static_cast<size_t>(value);
+    if (index >= N) {
+        return {};
+    }
+
+    return m_names[index];
+}
+
+template<typename E, size_t N>
+constexpr uint32_t enum_codec<E, N>::key_of(const std::string_view str) {
+    if (str.empty()) {
+        return 0;
+    }
+
+    const auto first = static_cast<uint8_t>(str.front());
+    const auto second = static_cast<uint8_t>(str.size() > 1 ? str[1] : 0);
+    const auto last = static_cast<uint8_t>(str.back());
+    return (static_cast<uint32_t>(str.size()) << 24) ^ (first << 16) ^ (second << 8) ^ last;
+}
+
+template<typename E, size_t N>
+constexpr size_t enum_codec<E, N>::slot_of(const uint32_t key, const uint32_t multiplier) {
+    return (key * multiplier) >> (32 - table_bits);
+}
+
+}
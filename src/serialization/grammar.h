@@ -0,0 +1,255 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <type_traits>
+
+#include "span_reader.h"
+#include "param_reader.h"
+
+// combinators to declare the grammar of a value once, from which both its reader and writer
+// are generated. every element has a static read(span_reader&, T&) and write(std::ostream&, const T&),
+// where T is the struct being read. members are bound with pointers to members.
+namespace sippy::serialization::grammar {
+
+template<size_t N>
+struct fixed_string {
+    consteval fixed_string(const char (&str)[N]) {
+        std::copy_n(str, N, value);
+    }
+
+    [[nodiscard]] constexpr std::string_view view() const {
+        return {value, N - 1};
+    }
+
+    char value[N]{};
+};
+
+// value codecs, used with field
+
+struct number {
+    template<typename V>
+    static void read(span_reader& reader, V& value) {
+        value = reader.read_number<V>();
+    }
+    template<typename V>
+    static void write(std::ostream& os, const V& value) {
+        os << value;
+    }
+};
+
+// enums and other types with their own span_reader and ostream operators
+struct enumeration {
+    template<typename V>
+    static void read(span_reader& reader, V& value) {
+        reader >> value;
+    }
+    template<typename V>
+    static void write(std::ostream& os, const V& value) {
+        os << value;
+    }
+};
+
+// comma separated enum values kept in a set, like INVITE, ACK, BYE
+struct enumeration_list {
+    template<typename S>
+    static void read(span_reader& reader, S& set) {
+        set.clear();
+        do {
+            reader.eat_while<is_whitespace>();
+
+            typename S::value_type value{};
+            reader >> value;
+            if (reader.failed()) {
+                return;
+            }
+
+            set.insert(value);
+            reader.eat_while<is_whitespace>();
+        } while (reader.eat_one_if<is_comma>());
+    }
+    template<typename S>
+    static void write(std::ostream& os, const S& set) {
+        bool first = true;
+        for (const auto value : set) {
+            if (!first) {
+                os << ", ";
+            }
+            first = false;
+            os << value;
+        }
+    }
+};
+
+// characters up to the first one matching End
+template<matcher End>
+struct text {
+    static void read(span_reader& reader, std::string& value) {
+        value = reader.read_until<End>();
+    }
+    static void write(std::ostream& os, const std::string& value) {
+        os << value;
+    }
+};
+
+// grammar elements
+
+template<auto Member, typename Codec>
+struct field {
+    template<typename T>
+    static void read(span_reader& reader, T& t) {
+        Codec::read(reader, t.*Member);
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T& t) {
+        Codec::write(os, t.*Member);
+    }
+};
+
+// a field which is only there when it starts with Prefix, like :port
+template<char Prefix, auto Member, typename Codec>
+struct optional_field {
+    template<typename T>
+    static void read(span_reader& reader, T& t) {
+        auto& member = t.*Member;
+        if (reader.peek(Prefix)) {
+            reader.eat(Prefix);
+            Codec::read(reader, member.emplace());
+        } else {
+            member = std::nullopt;
+        }
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T& t) {
+        const auto& member = t.*Member;
+        if (member.has_value()) {
+            os << Prefix;
+            Codec::write(os, member.value());
+        }
+    }
+};
+
+template<char Ch>
+struct literal {
+    template<typename T>
+    static void read(span_reader& reader, T&) {
+        reader.eat(Ch);
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T&) {
+        os << Ch;
+    }
+};
+
+// any amount of spaces when read, a single one when written
+struct space {
+    template<typename T>
+    static void read(span_reader& reader, T&) {
+        reader.eat_while<is_whitespace>();
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T&) {
+        os << ' ';
+    }
+};
+
+// ;name=value list kept as a map. values keep their quoting, and whether they had one at all
+template<auto Member>
+struct params {
+    template<typename T>
+    static void read(span_reader& reader, T& t) {
+        auto& member = t.*Member;
+        using value_type = typename std::remove_reference_t<decltype(member)>::mapped_type;
+        member.clear();
+
+        param_reader params(reader, ';', true);
+        while (const auto param = params.next()) {
+            value_type value;
+            if (param->has_value) {
+                value.value = std::string(param->value);
+                value.quoted = param->quoted;
+            }
+            member.emplace(param->name, std::move(value));
+        }
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T& t) {
+        for (const auto& [name, value] : t.*Member) {
+            os << ';' << name;
+            if (!value.value.has_value()) {
+                continue;
+            }
+
+            os << '=';
+            if (value.quoted) {
+                os << '"' << value.value.value() << '"';
+            } else {
+                os << value.value.value();
+            }
+        }
+    }
+};
+
+// one parameter out of a ;name=value list, the others are read and dropped.
+// empty when there without a value, quoted values are stored with their quotes.
+template<fixed_string Name, auto Member>
+struct param {
+    template<typename T>
+    static void read(span_reader& reader, T& t) {
+        auto& member = t.*Member;
+        member = std::nullopt;
+
+        param_reader params(reader, ';', true);
+        while (const auto param = params.next()) {
+            if (param->name != Name.view()) {
+                continue;
+            }
+
+            if (param->quoted) {
+                member = std::string(param->value.data() - 1, param->value.size() + 2);
+            } else {
+                member = param->value;
+            }
+        }
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T& t) {
+        const auto& member = t.*Member;
+        if (!member.has_value()) {
+            return;
+        }
+
+        os << ';' << Name.view();
+        if (!member.value().empty()) {
+            os << '=' << member.value();
+        }
+    }
+};
+
+// a ;name=value list which is not kept
+struct skip_params {
+    template<typename T>
+    static void read(span_reader& reader, T&) {
+        param_reader params(reader, ';', true);
+        while (params.next()) {}
+    }
+    template<typename T>
+    static void write(std::ostream&, const T&) {}
+};
+
+template<typename... Elements>
+struct sequence {
+    template<typename T>
+    static void read(span_reader& reader, T& t) {
+        (Elements::read(reader, t), ...);
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T& t) {
+        (Elements::write(os, t), ...);
+    }
+};
+
+}
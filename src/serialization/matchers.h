@@ -1,5 +1,7 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 
 namespace sippy::serialization {
 
@@ -41,6 +43,14 @@ static constexpr bool is_semicolon(const char c) {
     return c == ';';
 }
 
+static constexpr bool is_comma(const char c) {
+    return c == ',';
+}
+
+static constexpr bool is_right_angle(const char c) {
+    return c == '>';
+}
+
 static constexpr bool is_slash(const char ch) {
     return ch == '/';
 }
@@ -49,6 +59,10 @@ static constexpr bool is_equal(const char ch) {
     return ch == '=';
 }
 
+static constexpr bool is_carriage_return(const char ch) {
+    return ch == '\r';
+}
+
 static constexpr bool is_new_line(const char ch) {
     return ch == '\r' || ch == '\n';
 }
@@ -85,4 +99,44 @@ static constexpr bool is_colon_or_newline(const char c) {
     return is_colon(c) || is_new_line(c);
 }
 
+static constexpr bool is_name_addr_delimiter(const char c) {
+    return c == '<' || is_semicolon(c) || is_comma(c);
+}
+
+static constexpr bool is_token(const char c) {
+    switch (c) {
+        case '-': case '.': case '!': case '%': case '*':
+        case '_': case '+': case '`': case '\'': case '~':
+            return true;
+        default:
+            return is_alphanumeric(c);
+    }
+}
+
+static constexpr bool is_param_value(const char c) {
+    // token or host, plus what shows up in unquoted auth values (base64 '/' and '=')
+    return is_token(c) || c == ':' || c == '[' || c == ']' || c == '@' || c == '/' || c == '=';
+}
+
+// lookup table over all byte values, built at compile time from a matcher.
+class char_class {
+public:
+    constexpr explicit char_class(const matcher matcher)
+        : m_table() {
+        for (size_t i = 0; i < m_table.size(); i++) {
+            m_table[i] = matcher(static_cast<char>(i));
+        }
+    }
+
+    constexpr bool operator()(const char c) const {
+        return m_table[static_cast<uint8_t>(c)];
+    }
+
+private:
+    std::array<bool, 256> m_table;
+};
+
+template<matcher Matcher>
+inline constexpr char_class char_class_of(Matcher);
+
 }
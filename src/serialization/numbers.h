@@ -0,0 +1,41 @@
+#pragma once
+
+#include <charconv>
+#include <concepts>
+#include <optional>
+#include <string_view>
+
+namespace sippy::serialization {
+
+// locale-free number decoding. reads the digits at [begin, end) into value, returning where
+// the digits ended, or nullptr if there are no digits or the number does not fit in T.
+template<std::integral T>
+const char* decode_number(const char* begin, const char* end, T& value, int base = 10);
+
+// decodes str as a whole, nothing but the number is allowed.
+template<std::integral T>
+std::optional<T> parse_number(std::string_view str, int base = 10);
+
+template<std::integral T>
+const char* decode_number(const char* begin, const char* end, T& value, const int base) {
+    const auto [ptr, ec] = std::from_chars(begin, end, value, base);
+    if (ec != std::errc()) {
+        return nullptr;
+    }
+
+    return ptr;
+}
+
+template<std::integral T>
+std::optional<T> parse_number(const std::string_view str, const int base) {
+    const auto end = str.data() + str.size();
+
+    T value{};
+    if (decode_number(str.data(), end, value, base) != end) {
+        return std::nullopt;
+    }
+
+    return value;
+}
+
+}
@@ -0,0 +1,54 @@
+
+#include "param_reader.h"
+
+namespace sippy::serialization {
+
+param_reader::param_reader(span_reader& reader, const char delimiter, const bool leading_delimiter)
+    : m_reader(reader)
+    , m_delimiter(delimiter)
+    , m_expect_delimiter(leading_delimiter)
+{}
+
+std::optional<param> param_reader::next() {
+    m_reader.eat_while<is_whitespace_or_tab>();
+    if (m_reader.eof()) {
+        return std::nullopt;
+    }
+
+    if (m_expect_delimiter) {
+        if (!m_reader.peek(m_delimiter)) {
+            return std::nullopt;
+        }
+
+        m_reader.eat(m_delimiter);
+        m_reader.eat_while<is_whitespace_or_tab>();
+    }
+    m_expect_delimiter = true;
+
+    param param{};
+    param.name = m_reader.read_while<is_token>();
+    if (param.name.empty()) {
+        m_reader.fail(read_error::unexpected_character);
+        return std::nullopt;
+    }
+
+    m_reader.eat_while<is_whitespace_or_tab>();
+    if (!m_reader.peek('=')) {
+        return param;
+    }
+
+    m_reader.eat('=');
+    m_reader.eat_while<is_whitespace_or_tab>();
+    param.has_value = true;
+
+    if (m_reader.peek('"')) {
+        param.value = m_reader.read_quoted_string();
+        param.quoted = true;
+    } else {
+        param.value = m_reader.read_while<is_param_value>();
+    }
+
+    return param;
+}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <optional>
+#include <string_view>
+
+#include "span_reader.h"
+
+namespace sippy::serialization {
+
+struct param {
+    std::string_view name;
+    std::string_view value;
+    // tells ;name apart from ;name= and name="value" from name=value
+    bool has_value;
+    bool quoted;
+};
+
+// reads name[=value] lists separated by a delimiter, like ;generic-params or ,auth-params.
+// quoted values are returned without their quotes. stops at the first character which does
+// not continue the list, leaving it in the reader.
+class param_reader {
+public:
+    param_reader(span_reader& reader, char delimiter, bool leading_delimiter);
+
+    std::optional<param> next();
+
+private:
+    span_reader& m_reader;
+    char m_delimiter;
+    bool m_expect_delimiter;
+};
+
+}
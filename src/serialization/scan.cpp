@@ -0,0 +1,94 @@
+
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SIPPY_SCAN_X86
+#endif
+
+#include "scan.h"
+
+namespace sippy::serialization {
+
+using scan_kernel = const char*(*)(const char*, const char*, const delimiter_set&);
+
+static const char* find_scalar(const char* begin, const char* end, const delimiter_set& delimiters) {
+    for (; begin < end; ++begin) {
+        const auto ch = *begin;
+        if (ch == delimiters[0] || ch == delimiters[1] || ch == delimiters[2] || ch == delimiters[3]) {
+            return begin;
+        }
+    }
+
+    return end;
+}
+
+#ifdef SIPPY_SCAN_X86
+
+__attribute__((target("sse2")))
+static const char* find_sse2(const char* begin, const char* end, const delimiter_set& delimiters) {
+    const auto d0 = _mm_set1_epi8(delimiters[0]);
+    const auto d1 = _mm_set1_epi8(delimiters[1]);
+    const auto d2 = _mm_set1_epi8(delimiters[2]);
+    const auto d3 = _mm_set1_epi8(delimiters[3]);
+
+    for (; end - begin >= 16; begin += 16) {
+        const auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+        const auto matches = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, d0), _mm_cmpeq_epi8(chunk, d1)),
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, d2), _mm_cmpeq_epi8(chunk, d3)));
+
+        const auto mask = static_cast<uint32_t>(_mm_movemask_epi8(matches));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+
+    return find_scalar(begin, end, delimiters);
+}
+
+__attribute__((target("avx2")))
+static const char* find_avx2(const char* begin, const char* end, const delimiter_set& delimiters) {
+    const auto d0 = _mm256_set1_epi8(delimiters[0]);
+    const auto d1 = _mm256_set1_epi8(delimiters[1]);
+    const auto d2 = _mm256_set1_epi8(delimiters[2]);
+    const auto d3 = _mm256_set1_epi8(delimiters[3]);
+
+    for (; end - begin >= 32; begin += 32) {
+        const auto chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+        const auto matches = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, d0), _mm256_cmpeq_epi8(chunk, d1)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, d2), _mm256_cmpeq_epi8(chunk, d3)));
+
+        const auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+        if (mask != 0) {
+            return begin + __builtin_ctz(mask);
+        }
+    }
+
+    // tail is shorter than a full avx2 register
+    return find_sse2(begin, end, delimiters);
+}
+
+#endif
+
+static scan_kernel select_kernel() {
+#ifdef SIPPY_SCAN_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return find_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return find_sse2;
+    }
+#endif
+
+    return find_scalar;
+}
+
+const char* find_first_of(const char* begin, const char* end, const delimiter_set& delimiters) {
+    static const scan_kernel kernel = select_kernel();
+    return kernel(begin, end, delimiters);
+}
+
+}
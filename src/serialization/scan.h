@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+
+namespace sippy::serialization {
+
+// the 1 to 4 characters find_first_of looks for, built from a literal at compile time.
+// unused slots repeat the last delimiter so the kernels always compare against 4.
+class delimiter_set {
+public:
+    template<size_t N>
+    consteval delimiter_set(const char (&delimiters)[N])
+        : m_delimiters() {
+        static_assert(N >= 2 && N <= 5, "delimiters must be 1 to 4 characters");
+        for (size_t i = 0; i < m_delimiters.size(); i++) {
+            m_delimiters[i] = delimiters[std::min(i, N - 2)];
+        }
+    }
+
+    [[nodiscard]] constexpr char operator[](const size_t index) const {
+        return m_delimiters[index];
+    }
+
+private:
+    std::array<char, 4> m_delimiters;
+};
+
+// finds the first character in [begin, end) which is one of delimiters.
+// uses the widest vector instructions the cpu supports, returns end if there is no match.
+const char* find_first_of(const char* begin, const char* end, const delimiter_set& delimiters);
+
+}
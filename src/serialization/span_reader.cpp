@@ -0,0 +1,121 @@
+
+#include "span_reader.h"
+
+namespace sippy::serialization {
+
+span_reader::span_reader(const std::string_view data)
+    : m_begin(data.data())
+    , m_ptr(data.data())
+    , m_end(data.data() + data.size())
+    , m_error(read_error::none)
+    , m_error_location(nullptr)
+{}
+
+span_reader::span_reader(const std::span<const uint8_t> data)
+    : span_reader(to_string_view(data))
+{}
+
+bool span_reader::eof() const {
+    return m_ptr >= m_end;
+}
+
+size_t span_reader::position() const {
+    return m_ptr - m_begin;
+}
+
+size_t span_reader::remaining() const {
+    return m_end - m_ptr;
+}
+
+bool span_reader::failed() const {
+    return m_error != read_error::none;
+}
+
+read_error span_reader::error() const {
+    return m_error;
+}
+
+const char* span_reader::error_location() const {
+    return m_error_location;
+}
+
+void span_reader::fail(const read_error error) {
+    if (m_error == read_error::none) {
+        m_error = error;
+        m_error_location = m_ptr;
+    }
+
+    m_ptr = m_end;
+}
+
+bool span_reader::peek(const char ch) const {
+    return m_ptr < m_end && *m_ptr == ch;
+}
+
+void span_reader::eat(const char ch) {
+    if (m_ptr >= m_end || *m_ptr != ch) {
+        fail(read_error::unexpected_character);
+        return;
+    }
+
+    ++m_ptr;
+}
+
+void span_reader::eat(const std::string_view str) {
+    if (remaining() < str.size() || std::string_view(m_ptr, str.size()) != str) {
+        fail(read_error::unexpected_character);
+        return;
+    }
+
+    m_ptr += str.size();
+}
+
+std::string_view span_reader::read(const size_t length) {
+    if (remaining() < length) {
+        fail(read_error::not_enough_characters);
+        return {};
+    }
+
+    const std::string_view result(m_ptr, length);
+    m_ptr += length;
+    return result;
+}
+
+std::string_view span_reader::read_until_any(const delimiter_set& delimiters) {
+    const auto start = m_ptr;
+    m_ptr = find_first_of(m_ptr, m_end, delimiters);
+
+    return {start, static_cast<size_t>(m_ptr - start)};
+}
+
+std::string_view span_reader::read_quoted_string() {
+    eat('"');
+    if (failed()) {
+        return {};
+    }
+
+    const auto start = m_ptr;
+    while (m_ptr < m_end && *m_ptr != '"') {
+        if (*m_ptr == '\\') {
+            // escaped pair, skip the escaped character as well
+            ++m_ptr;
+        }
+        ++m_ptr;
+    }
+
+    if (m_ptr >= m_end) {
+        m_ptr = start;
+        fail(read_error::not_enough_characters);
+        return {};
+    }
+
+    const std::string_view result(start, m_ptr - start);
+    ++m_ptr;
+    return result;
+}
+
+std::string_view to_string_view(const std::span<const uint8_t> data) {
+    return {reinterpret_cast<const char*>(data.data()), data.size()};
+}
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <concepts>
+
+#include "matchers.h"
+#include "numbers.h"
+#include "scan.h"
+
+namespace sippy::serialization {
+
+enum class read_error {
+    none,
+    unexpected_character,
+    not_enough_characters,
+    bad_number,
+    unknown_value,
+    invalid_value
+};
+
+// reader over a contiguous buffer, everything read is a view into the buffer.
+// errors do not throw: the first one is kept and the reader stops at the end of its buffer,
+// so every following read comes back empty. callers check failed() at convenient points.
+class span_reader {
+public:
+    explicit span_reader(std::string_view data);
+    explicit span_reader(std::span<const uint8_t> data);
+
+    [[nodiscard]] bool eof() const;
+    [[nodiscard]] size_t position() const;
+    [[nodiscard]] size_t remaining() const;
+
+    [[nodiscard]] bool failed() const;
+    [[nodiscard]] read_error error() const;
+    // where in the buffer the first error happened
+    [[nodiscard]] const char* error_location() const;
+    void fail(read_error error);
+
+    [[nodiscard]] bool peek(char ch) const;
+
+    void eat(char ch);
+    void eat(std::string_view str);
+    template<matcher Matcher>
+    bool eat_one_if();
+    template<matcher Matcher>
+    void eat_while();
+
+    std::string_view read(size_t length);
+    template<matcher Matcher>
+    std::string_view read_while();
+    template<matcher Matcher>
+    std::string_view read_until();
+    std::string_view read_until_any(const delimiter_set& delimiters);
+    std::string_view read_quoted_string();
+
+    // fails with bad_number if there are no digits or the number does not fit in T
+    template<std::integral T>
+    T read_number(int base = 10);
+
+private:
+    const char* m_begin;
+    const char* m_ptr;
+    const char* m_end;
+    read_error m_error;
+    const char* m_error_location;
+};
+
+std::string_view to_string_view(std::span<const uint8_t> data);
+
+template<matcher Matcher>
+bool span_reader::eat_one_if() {
+    constexpr auto& cls = char_class_of<Matcher>;
+    if (m_ptr < m_end && cls(*m_ptr)) {
+        ++m_ptr;
+        return true;
+    }
+
+    return false;
+}
+
+template<matcher Matcher>
+void span_reader::eat_while() {
+    constexpr auto& cls = char_class_of<Matcher>;
+    while (m_ptr < m_end && cls(*m_ptr)) {
+        ++m_ptr;
+    }
+}
+
+template<matcher Matcher>
+std::string_view span_reader::read_while() {
+    constexpr auto& cls = char_class_of<Matcher>;
+    const auto start = m_ptr;
+    while (m_ptr < m_end && cls(*m_ptr)) {
+        ++m_ptr;
+    }
+
+    return {start, static_cast<size_t>(m_ptr - start)};
+}
+
+template<matcher Matcher>
+std::string_view span_reader::read_until() {
+    constexpr auto& cls = char_class_of<Matcher>;
+    const auto start = m_ptr;
+    while (m_ptr < m_end && !cls(*m_ptr)) {
+        ++m_ptr;
+    }
+
+    return {start, static_cast<size_t>(m_ptr - start)};
+}
+
+template<std::integral T>
+T span_reader::read_number(const int base) {
+    T value{};
+    const auto ptr = decode_number(m_ptr, m_end, value, base);
+    if (ptr == nullptr) {
+        fail(read_error::bad_number);
+        return T{};
+    }
+
+    m_ptr = ptr;
+    return value;
+}
+
+}
@@ -3,13 +3,14 @@
 
 #include "serialization/matchers.h"
 #include "serialization/reader.h"
+#include "serialization/span_reader.h"
 
 
 using namespace sippy;
 
 
 DEFINE_SIP_BODY_READ(test) {
-    is >> b.v;
+    b.v = reader.read_until<serialization::is_whitespace>();
 }
 
 DEFINE_SIP_BODY_WRITE(test) {
@@ -17,7 +18,14 @@ DEFINE_SIP_BODY_WRITE(test) {
 }
 
 DEFINE_SIP_BODY_READ(sdp) {
-    b.description = sippy::sdp::parse(is);
+    const auto data = reader.read(reader.remaining());
+    auto result = sippy::sdp::try_parse({reinterpret_cast<const uint8_t*>(data.data()), data.size()});
+    if (!result) {
+        reader.fail(serialization::read_error::invalid_value);
+        return;
+    }
+
+    b.description = std::move(result.value());
 }
 
 DEFINE_SIP_BODY_WRITE(sdp) {
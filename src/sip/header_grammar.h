@@ -0,0 +1,49 @@
+#pragma once
+
+#include <sip/headers.h>
+
+#include "serialization/grammar.h"
+
+namespace sippy::sip::grammar {
+
+using namespace serialization::grammar;
+
+// name-addr: [display-name] <uri>, or a plain addr-spec without brackets
+void read_name_addr(serialization::span_reader& reader, std::optional<std::string>& display_name, std::string& uri);
+
+// DisplayName may be nullptr for headers which don't keep it
+template<auto DisplayName, auto Uri>
+struct name_addr {
+    template<typename T>
+    static void read(serialization::span_reader& reader, T& t) {
+        if constexpr (std::is_null_pointer_v<decltype(DisplayName)>) {
+            std::optional<std::string> display_name;
+            read_name_addr(reader, display_name, t.*Uri);
+        } else {
+            read_name_addr(reader, t.*DisplayName, t.*Uri);
+        }
+    }
+    template<typename T>
+    static void write(std::ostream& os, const T& t) {
+        if constexpr (!std::is_null_pointer_v<decltype(DisplayName)>) {
+            const auto& display_name = t.*DisplayName;
+            if (display_name.has_value()) {
+                os << display_name.value();
+                os << ' ';
+            }
+        }
+
+        os << '<' << t.*Uri << '>';
+    }
+};
+
+}
+
+// defines both the reader and writer of a header from its grammar, a list of elements
+#define DEFINE_SIP_HEADER_GRAMMAR(h_name, ...) \
+    DEFINE_SIP_HEADER_READ(h_name) { \
+        sippy::sip::grammar::sequence<__VA_ARGS__>::read(reader, h); \
+    } \
+    DEFINE_SIP_HEADER_WRITE(h_name) { \
+        sippy::sip::grammar::sequence<__VA_ARGS__>::write(os, h); \
+    }
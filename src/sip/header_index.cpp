@@ -0,0 +1,192 @@
+
+#include <cstdint>
+#include <limits>
+
+#include <sip/header_index.h>
+
+#include "serialization/span_reader.h"
+#include "util/string_helper.h"
+#include "types_storage.h"
+#include "reader.h"
+
+namespace sippy::sip {
+
+std::expected<header_index, parse_error> header_index::build(const std::span<const uint8_t> buffer) {
+    // lines keep 32 bit offsets, which fit anything inside such a buffer
+    if (buffer.size() > std::numeric_limits<uint32_t>::max()) {
+        return std::unexpected(parse_error{parse_error_code::message_too_large, 0, {}});
+    }
+
+    header_index index(serialization::to_string_view(buffer));
+
+    serialization::span_reader reader(buffer);
+    header_reader header_reader(reader);
+
+    const auto start_line = header_reader.read_start_line();
+    index.m_start_line_size = static_cast<uint32_t>(start_line->size());
+
+    std::string_view name;
+    while (!reader.failed()) {
+        const auto nameOpt = header_reader.read_header_name();
+        if (!nameOpt.has_value()) {
+            break;
+        }
+        name = nameOpt.value();
+
+        const auto name_offset = static_cast<size_t>(name.data() - index.m_buffer.data());
+        if (index.m_line_count >= max_headers) {
+            return std::unexpected(parse_error{parse_error_code::too_many_headers, name_offset, std::string(name)});
+        }
+        if (name.size() > std::numeric_limits<decltype(line::name_size)>::max()) {
+            return std::unexpected(parse_error{parse_error_code::header_line_too_long, name_offset, std::string(name)});
+        }
+
+        bool folded;
+        const auto value = header_reader.read_raw_header_value(folded);
+
+        auto& line = index.m_lines[index.m_line_count++];
+        line.name_offset = static_cast<uint32_t>(name_offset);
+        line.name_size = static_cast<uint16_t>(name.size());
+        line.value_offset = static_cast<uint32_t>(value.data() - index.m_buffer.data());
+        line.value_size = static_cast<uint32_t>(value.size());
+        line.folded = folded;
+    }
+
+    reader.eat("\r\n");
+    if (reader.failed()) {
+        const auto offset = static_cast<size_t>(reader.error_location() - index.m_buffer.data());
+        return std::unexpected(parse_error{to_parse_error_code(reader.error()), offset, std::string(name)});
+    }
+
+    index.m_body_offset = static_cast<uint32_t>(reader.position());
+    return index;
+}
+
+header_index::header_index(const std::string_view buffer)
+    : m_buffer(buffer)
+    , m_start_line_size(0)
+    , m_body_offset(0)
+    , m_lines()
+    , m_line_count(0)
+{}
+
+std::string_view header_index::start_line() const {
+    return m_buffer.substr(0, m_start_line_size);
+}
+
+bool header_index::is_request() const {
+    return !is_response();
+}
+
+bool header_index::is_response() const {
+    return start_line().starts_with("SIP/");
+}
+
+size_t header_index::body_offset() const {
+    return m_body_offset;
+}
+
+size_t header_index::line_count() const {
+    return m_line_count;
+}
+
+std::string_view header_index::name(const size_t line) const {
+    const auto& entry = m_lines.at(line);
+    return m_buffer.substr(entry.name_offset, entry.name_size);
+}
+
+std::string_view header_index::raw_value(const size_t line) const {
+    const auto& entry = m_lines.at(line);
+    return m_buffer.substr(entry.value_offset, entry.value_size);
+}
+
+bool header_index::_is_header(const line& line, const std::string_view name) const {
+    const auto line_name = m_buffer.substr(line.name_offset, line.name_size);
+    if (util::equals_ignore_case(line_name, name)) {
+        return true;
+    }
+
+    if (line_name.size() == 1) {
+        // compact form
+        const auto def = headers::storage::get_header(line_name);
+        return def != nullptr && def->name() == name;
+    }
+
+    return false;
+}
+
+std::optional<std::string_view> header_index::_find_value(
+    const std::string_view name,
+    const bool allow_multiple,
+    size_t index,
+    std::string& buffer) const {
+    for (size_t i = 0; i < m_line_count; i++) {
+        const auto& line = m_lines[i];
+        if (!_is_header(line, name)) {
+            continue;
+        }
+
+        auto value = m_buffer.substr(line.value_offset, line.value_size);
+        if (line.folded) {
+            unfold_header_value(value, buffer);
+            value = buffer;
+        }
+
+        if (!allow_multiple) {
+            if (index == 0) {
+                return value;
+            }
+
+            index--;
+            continue;
+        }
+
+        std::optional<std::string_view> found;
+        split_header_values(value, [&index, &found](const std::string_view part) {
+            if (!found && index-- == 0) {
+                found = part;
+            }
+        });
+
+        if (found) {
+            return util::trim_whitespace(found.value());
+        }
+    }
+
+    return std::nullopt;
+}
+
+size_t header_index::_header_count(const std::string_view name, const bool allow_multiple) const {
+    size_t count = 0;
+    for (size_t i = 0; i < m_line_count; i++) {
+        const auto& line = m_lines[i];
+        if (!_is_header(line, name)) {
+            continue;
+        }
+
+        if (allow_multiple) {
+            const auto value = m_buffer.substr(line.value_offset, line.value_size);
+            split_header_values(value, [&count](std::string_view) {
+                count++;
+            });
+        } else {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void header_index::_decode_header(headers::storage::_base_header_holder& holder, const size_t index) const {
+    const auto allow_multiple = (holder.flags() & headers::flag_allow_multiple) != 0;
+
+    std::string buffer;
+    const auto value = _find_value(holder.name(), allow_multiple, index, buffer);
+    if (!value.has_value()) {
+        throw headers::header_not_found();
+    }
+
+    decode_header_value(holder, value.value());
+}
+
+}
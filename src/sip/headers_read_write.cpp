@@ -1,335 +1,150 @@
 #include <iomanip>
-#include <regex>
 
 #include <sip/headers.h>
 
-#include "serialization/reader.h"
+#include "serialization/span_reader.h"
+#include "serialization/param_reader.h"
+#include "util/string_helper.h"
+#include "header_grammar.h"
 
 
 using namespace sippy::sip;
 
-static std::map<std::string, std::string> parse_tags(std::string& str) {
-    // with ; as delim
-    std::regex regex(R"((?:\s*;\s*(\w+)=(?:\")?([\d\w@\-\.\+]+)(?:\")?))");
-    std::smatch match;
-    std::map<std::string, std::string> tags;
+void sippy::sip::grammar::read_name_addr(serialization::span_reader& reader, std::optional<std::string>& display_name, std::string& uri) {
+    reader.eat_while<serialization::is_whitespace_or_tab>();
 
-    while (std::regex_search(str, match, regex)) {
-        tags.emplace(match.str(1), match.str(2));
-        str = match.suffix();
-    }
-
-    return std::move(tags);
-}
-
-static std::map<std::string, std::string> parse_params(std::string& str) {
-    // with , as delim
-    if (str[0] != ',') {
-        str = ',' + str;
-    }
-
-    std::regex regex(R"((?:\s*,\s*(\w+)=(?:\")?([\d\w@\-\.\+/=]+)(?:\")?))");
-    std::smatch match;
-    std::map<std::string, std::string> tags;
-
-    while (std::regex_search(str, match, regex)) {
-        tags.emplace(match.str(1), match.str(2));
-        str = match.suffix();
-    }
-
-    return std::move(tags);
-}
-
-static void write_tags(std::ostream& os, const std::map<std::string, std::string>& tags) {
-    for (const auto& [name, value] : tags) {
-        os << ';' << name << '=' << value;
-    }
-}
-
-DEFINE_SIP_HEADER_READ(from) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
-
-    const auto match = serialization::parse(str, R"(^(?:(\"?.+\"?)\s+)?<?(\w+:[\w@\-\.\+]+)>?\s*(?:;\s*tag=(.+))?$)");
-    if (match[1].matched) {
-        h.display_name = match[1].str();
-    } else {
-        h.display_name = std::nullopt;
-    }
-    h.uri = match[2].str();
-    if (match[3].matched) {
-        h.tag = match[3].str();
+    if (reader.peek('"')) {
+        const auto quoted = reader.read_quoted_string();
+        // the display name is stored with its quotes
+        display_name = std::string(quoted.data() - 1, quoted.size() + 2);
+        reader.eat_while<serialization::is_whitespace_or_tab>();
     } else {
-        h.tag = std::nullopt;
-    }
-}
-
-DEFINE_SIP_HEADER_WRITE(from) {
-    if (h.display_name) {
-        os << h.display_name.value();
-        os << ' ';
-    }
-
-    os << '<' << h.uri << '>';
-
-    if (h.tag) {
-        os << ";tag=" << h.tag.value();
-    }
-}
-
-DEFINE_SIP_HEADER_READ(to) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
-
-    const auto match = serialization::parse(str, R"(^(?:(\"?.+\"?)\s+)?<?(\w+:[\w@\-\.\+]+)>?\s*(?:;\s*tag=(.+))?$)");
-    if (match[1].matched) {
-        h.display_name = match[1].str();
-    } else {
-        h.display_name = std::nullopt;
-    }
-    h.uri = match[2].str();
-    if (match[3].matched) {
-        h.tag = match[3].str();
-    } else {
-        h.tag = std::nullopt;
-    }
-}
-
-DEFINE_SIP_HEADER_WRITE(to) {
-    if (h.display_name) {
-        os << h.display_name.value();
-        os << ' ';
-    }
-
-    os << '<' << h.uri << '>';
-
-    if (h.tag) {
-        os << ";tag=" << h.tag.value();
-    }
-}
+        const auto tokens = reader.read_until<serialization::is_name_addr_delimiter>();
+        if (!reader.peek('<')) {
+            display_name = std::nullopt;
+            uri = util::trim_whitespace(tokens);
+            return;
+        }
 
-DEFINE_SIP_HEADER_READ(contact) {
-    serialization::reader reader(is);
-    {
-        auto str = reader.read_until(serialization::is_semicolon);
-        const auto match = serialization::parse(str, R"(^(?:(\"?.+\"?)\s+)?<?(\w+:[\d\w@\-\.\+:]+)>?\s*$)");
-        if (match[1].matched) {
-            h.display_name = match[1].str();
+        const auto name = util::trim_whitespace(tokens);
+        if (name.empty()) {
+            display_name = std::nullopt;
         } else {
-            h.display_name = std::nullopt;
+            display_name = name;
         }
-        h.uri = match[2].str();
-    }
-    {
-        auto str = reader.read_until(serialization::is_new_line);
-        h.tags = parse_tags(str);
-    }
-}
-
-DEFINE_SIP_HEADER_WRITE(contact) {
-    if (h.display_name) {
-        os << h.display_name.value();
-        os << ' ';
-    }
-
-    os << '<' << h.uri << '>';
-
-    write_tags(os, h.tags);
-}
-
-DEFINE_SIP_HEADER_READ(via) {
-    serialization::reader reader(is);
-
-    is >> h.version;
-    reader.eat('/');
-    is >> h.transport;
-
-    reader.eat_while(serialization::is_whitespace);
-    h.host = reader.read_until(serialization::is_colon_or_semicolon);
-
-    if (reader.peek(':')) {
-        reader.eat(':');
-
-        uint16_t v;
-        is >> v;
-        h.port = v;
-    } else {
-        h.port = std::nullopt;
     }
 
-    {
-        auto str = reader.read_until(serialization::is_new_line);
-        h.tags = parse_tags(str);
-    }
+    reader.eat('<');
+    uri = reader.read_until<serialization::is_right_angle>();
+    reader.eat('>');
+    reader.eat_while<serialization::is_whitespace_or_tab>();
 }
 
-DEFINE_SIP_HEADER_WRITE(via) {
-    os << h.version;
-    os << '/';
-    os << h.transport;
-    os << ' ';
-    os << h.host;
-    if (h.port) {
-        os << ':';
-        os << h.port.value();
-    }
-    write_tags(os, h.tags);
-}
+using namespace sippy::sip::grammar;
 
-DEFINE_SIP_HEADER_READ(content_length) {
-    is >> h.length;
-}
+DEFINE_SIP_HEADER_GRAMMAR(from,
+    name_addr<&headers::from::display_name, &headers::from::uri>,
+    param<"tag", &headers::from::tag>)
 
-DEFINE_SIP_HEADER_WRITE(content_length) {
-    os << h.length;
-}
+DEFINE_SIP_HEADER_GRAMMAR(to,
+    name_addr<&headers::to::display_name, &headers::to::uri>,
+    param<"tag", &headers::to::tag>)
 
-DEFINE_SIP_HEADER_READ(content_type) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
+DEFINE_SIP_HEADER_GRAMMAR(contact,
+    name_addr<&headers::contact::display_name, &headers::contact::uri>,
+    params<&headers::contact::tags>)
 
-    h.type = std::move(str);
-}
+DEFINE_SIP_HEADER_GRAMMAR(via,
+    field<&headers::via::version, enumeration>,
+    literal<'/'>,
+    field<&headers::via::transport, enumeration>,
+    space,
+    field<&headers::via::host, text<serialization::is_colon_or_semicolon>>,
+    optional_field<':', &headers::via::port, number>,
+    params<&headers::via::tags>)
 
-DEFINE_SIP_HEADER_WRITE(content_type) {
-    os << h.type;
-}
+DEFINE_SIP_HEADER_GRAMMAR(content_length,
+    field<&headers::content_length::length, number>)
 
-DEFINE_SIP_HEADER_READ(cseq) {
-    serialization::reader reader(is);
+DEFINE_SIP_HEADER_GRAMMAR(content_type,
+    field<&headers::content_type::type, text<serialization::is_new_line>>)
 
-    is >> h.seq_num;
-    reader.eat_while(serialization::is_whitespace);
-    is >> h.method;
-}
+DEFINE_SIP_HEADER_GRAMMAR(cseq,
+    field<&headers::cseq::seq_num, number>,
+    space,
+    field<&headers::cseq::method, enumeration>)
 
-DEFINE_SIP_HEADER_WRITE(cseq) {
-    os << h.seq_num;
-    os << ' ';
-    os << h.method;
-}
+DEFINE_SIP_HEADER_GRAMMAR(call_id,
+    field<&headers::call_id::value, text<serialization::is_new_line>>)
 
-DEFINE_SIP_HEADER_READ(call_id) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
+DEFINE_SIP_HEADER_GRAMMAR(max_forwards,
+    field<&headers::max_forwards::value, number>)
 
-    h.value = std::move(str);
-}
+DEFINE_SIP_HEADER_GRAMMAR(min_expires,
+    field<&headers::min_expires::value, number>)
 
-DEFINE_SIP_HEADER_WRITE(call_id) {
-    os << h.value;
-}
+DEFINE_SIP_HEADER_GRAMMAR(expires,
+    field<&headers::expires::value, number>)
 
-DEFINE_SIP_HEADER_READ(max_forwards) {
-    is >> h.value;
-}
+// rr-params are not kept
+DEFINE_SIP_HEADER_GRAMMAR(route,
+    name_addr<nullptr, &headers::route::uri>,
+    skip_params)
 
-DEFINE_SIP_HEADER_WRITE(max_forwards) {
-    os << h.value;
-}
+DEFINE_SIP_HEADER_GRAMMAR(record_route,
+    name_addr<nullptr, &headers::record_route::uri>,
+    skip_params)
 
-DEFINE_SIP_HEADER_READ(min_expires) {
-    is >> h.value;
-}
+DEFINE_SIP_HEADER_GRAMMAR(server,
+    field<&headers::server::value, text<serialization::is_new_line>>)
 
-DEFINE_SIP_HEADER_WRITE(min_expires) {
-    os << h.value;
-}
+DEFINE_SIP_HEADER_GRAMMAR(subject,
+    field<&headers::subject::value, text<serialization::is_new_line>>)
 
-DEFINE_SIP_HEADER_READ(expires) {
-    is >> h.value;
-}
-
-DEFINE_SIP_HEADER_WRITE(expires) {
-    os << h.value;
-}
-
-DEFINE_SIP_HEADER_READ(route) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_semicolon);
-    const auto match = serialization::parse(str, R"(^<(.+)>$)");
-    h.uri = match[1].str();
-}
-
-DEFINE_SIP_HEADER_WRITE(route) {
-    os << '<' << h.uri << '>';
-}
-
-DEFINE_SIP_HEADER_READ(record_route) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
-    const auto match = serialization::parse(str, R"(^<(.+)(?:;[\w\d./=]+)?>)");
-    h.uri = match[1].str();
-}
-
-DEFINE_SIP_HEADER_WRITE(record_route) {
-    os << '<' << h.uri << '>';
-}
-
-DEFINE_SIP_HEADER_READ(server) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
-
-    h.value = std::move(str);
-}
-
-DEFINE_SIP_HEADER_WRITE(server) {
-    os << h.value;
-}
-
-DEFINE_SIP_HEADER_READ(subject) {
-    serialization::reader reader(is);
-    auto str = reader.read_until(serialization::is_new_line);
-
-    h.value = std::move(str);
-}
-
-DEFINE_SIP_HEADER_WRITE(subject) {
-    os << h.value;
-}
-
-DEFINE_SIP_HEADER_READ(allow) {
-    is >> h.method;
-}
-
-DEFINE_SIP_HEADER_WRITE(allow) {
-    os << h.method;
-}
+DEFINE_SIP_HEADER_GRAMMAR(allow,
+    field<&headers::allow::methods, enumeration_list>)
 
+// auth-params come in any order and are quoted differently per name, so these stay hand written
 DEFINE_SIP_HEADER_READ(authorization) {
-    serialization::reader reader(is);
-    is >> h.scheme;
-    reader.eat_while(serialization::is_whitespace);
-
-    auto str = reader.read_until(serialization::is_new_line);
-    auto tags = parse_params(str);
-    h.username = tags["username"];
-    h.uri = tags["uri"];
-    h.realm = tags["realm"];
-    h.qop = tags["qop"];
-    h.nonce = tags["nonce"];
-
-    {
-        std::stringstream ss(tags["algorithm"]);
-        ss >> h.algorithm;
-    }
-
-    if (tags.contains("nc")) {
-        h.nc = std::stoi(tags["nc"]);
-    } else {
-        h.nc = std::nullopt;
-    }
-
-    if (tags.contains("cnonce")) {
-        h.cnonce = tags["cnonce"];
-    } else {
-        h.cnonce = std::nullopt;
-    }
-
-    if (tags.contains("response")) {
-        h.response = tags["response"];
-    } else {
-        h.response = std::nullopt;
+    reader >> h.scheme;
+    reader.eat_while<serialization::is_whitespace>();
+
+    h.algorithm = auth_algorithm::md5;
+    h.nc = std::nullopt;
+    h.cnonce = std::nullopt;
+    h.response = std::nullopt;
+
+    serialization::param_reader params(reader, ',', false);
+    while (const auto param = params.next()) {
+        const auto name = param->name;
+        const auto value = param->value;
+        if (name == "username") {
+            h.username = value;
+        } else if (name == "uri") {
+            h.uri = value;
+        } else if (name == "realm") {
+            h.realm = value;
+        } else if (name == "qop") {
+            h.qop = value;
+        } else if (name == "nonce") {
+            h.nonce = value;
+        } else if (name == "algorithm") {
+            serialization::span_reader algorithm_reader(value);
+            algorithm_reader >> h.algorithm;
+            if (algorithm_reader.failed()) {
+                reader.fail(algorithm_reader.error());
+            }
+        } else if (name == "nc") {
+            serialization::span_reader nc_reader(value);
+            h.nc = nc_reader.read_number<uint32_t>();
+            if (nc_reader.failed()) {
+                reader.fail(nc_reader.error());
+            }
+        } else if (name == "cnonce") {
+            h.cnonce = value;
+        } else if (name == "response") {
+            h.response = value;
+        }
     }
 }
 
@@ -355,20 +170,30 @@ DEFINE_SIP_HEADER_WRITE(authorization) {
 }
 
 DEFINE_SIP_HEADER_READ(www_authorization) {
-    serialization::reader reader(is);
-    is >> h.scheme;
-    reader.eat_while(serialization::is_whitespace);
-
-    auto str = reader.read_until(serialization::is_new_line);
-    auto tags = parse_params(str);
-    h.uri = tags["uri"];
-    h.realm = tags["realm"];
-    h.qop = tags["qop"];
-    h.nonce = tags["nonce"];
-
-    {
-        std::stringstream ss(tags["algorithm"]);
-        ss >> h.algorithm;
+    reader >> h.scheme;
+    reader.eat_while<serialization::is_whitespace>();
+
+    h.algorithm = auth_algorithm::md5;
+
+    serialization::param_reader params(reader, ',', false);
+    while (const auto param = params.next()) {
+        const auto name = param->name;
+        const auto value = param->value;
+        if (name == "uri") {
+            h.uri = value;
+        } else if (name == "realm") {
+            h.realm = value;
+        } else if (name == "qop") {
+            h.qop = value;
+        } else if (name == "nonce") {
+            h.nonce = value;
+        } else if (name == "algorithm") {
+            serialization::span_reader algorithm_reader(value);
+            algorithm_reader >> h.algorithm;
+            if (algorithm_reader.failed()) {
+                reader.fail(algorithm_reader.error());
+            }
+        }
     }
 }
 
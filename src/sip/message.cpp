@@ -1,5 +1,8 @@
 
+#include <ranges>
+
 #include <sip/message.h>
+#include <sip/message_pool.h>
 
 #include "serialization/matchers.h"
 #include "serialization/reader.h"
@@ -61,6 +64,93 @@ status_line::status_line(const sip::version version, const sip::status_code code
     , reason_phrase(reason_phrase)
 {}
 
+bool parse_options::should_decode(const size_t id) const {
+    // the body can't be framed without these, so their errors must be found while parsing
+    if (id == headers::meta::_header_detail<headers::content_length>::id() ||
+        id == headers::meta::_header_detail<headers::content_type>::id()) {
+        return true;
+    }
+    if (lazy_headers) {
+        return false;
+    }
+    if (decoded_headers.empty()) {
+        return true;
+    }
+
+    return id < headers::meta::_dynamic_header_id && decoded_headers.contains(static_cast<headers::meta::_known_header>(id));
+}
+
+message_deleter::message_deleter(std::default_delete<message>)
+    : pool(nullptr)
+{}
+
+message_deleter::message_deleter(message_pool* pool)
+    : pool(pool)
+{}
+
+void message_deleter::operator()(message* msg) const {
+    if (pool != nullptr) {
+        pool->recycle(msg);
+    } else {
+        delete msg;
+    }
+}
+
+parse_exception::parse_exception(parse_error error)
+    : m_error(std::move(error))
+{}
+
+const parse_error& parse_exception::error() const {
+    return m_error;
+}
+
+const char* parse_exception::what() const noexcept {
+    return parse_error_str(m_error.code);
+}
+
+const char* parse_error_str(const parse_error_code code) {
+    switch (code) {
+        case parse_error_code::unexpected_character:
+            return "unexpected character";
+        case parse_error_code::not_enough_characters:
+            return "not enough characters";
+        case parse_error_code::bad_number:
+            return "bad number";
+        case parse_error_code::unknown_value:
+            return "unknown value";
+        case parse_error_code::invalid_value:
+            return "invalid value";
+        case parse_error_code::bad_start_line:
+            return "bad start line";
+        case parse_error_code::missing_header_value:
+            return "missing header value";
+        case parse_error_code::header_value_trailing_data:
+            return "trailing data in header";
+        case parse_error_code::missing_content_type:
+            return "missing content type";
+        case parse_error_code::unknown_body:
+            return "unknown body";
+        case parse_error_code::bad_body:
+            return "bad body";
+        case parse_error_code::body_trailing_data:
+            return "trailing data in body";
+        case parse_error_code::too_many_headers:
+            return "too many headers";
+        case parse_error_code::message_too_large:
+            return "message too large";
+        case parse_error_code::header_line_too_long:
+            return "header line too long";
+        case parse_error_code::too_many_header_values:
+            return "too many header values";
+        case parse_error_code::body_too_large:
+            return "body too large";
+        case parse_error_code::bad_content_length:
+            return "bad content length";
+        default:
+            return "unknown parse error";
+    }
+}
+
 std::istream& operator>>(std::istream& is, request_line& line) {
     serialization::reader reader(is);
 
@@ -105,18 +195,70 @@ std::ostream& operator<<(std::ostream& os, const status_line& line) {
     return os;
 }
 
-message_ptr parse(std::istream& is) {
-    reader reader(is);
+message_ptr parse(std::istream& is, const parse_options& options) {
+    const std::string data{std::istreambuf_iterator<char>(is), std::istreambuf_iterator<char>()};
+    return parse({reinterpret_cast<const uint8_t*>(data.data()), data.size()}, options);
+}
+
+message_ptr parse(const std::span<const uint8_t> buffer, const parse_options& options) {
+    auto result = try_parse(buffer, options);
+    if (!result) {
+        throw parse_exception(std::move(result.error()));
+    }
+
+    return std::move(result.value());
+}
+
+static std::expected<message_ptr, parse_error> read_message(
+    const std::span<const uint8_t> buffer,
+    const parse_options& options,
+    std::shared_ptr<const void> buffer_owner) {
+    reader reader(buffer, options, std::move(buffer_owner));
     reader.reset();
     reader.parse_headers();
     reader.parse_body();
+
+    if (reader.failed()) {
+        return std::unexpected(reader.release_error());
+    }
+
     return reader.release();
 }
 
-message_ptr parse(const std::span<const uint8_t> buffer) {
-    util::istream_buff buff(buffer);
-    std::istream is(&buff);
-    return parse(is);
+static std::expected<message_ptr, parse_error> parse_buffer(
+    const std::span<const uint8_t> buffer,
+    const parse_options& options,
+    std::shared_ptr<const void> buffer_owner) {
+    if (auto error = check_limits(serialization::to_string_view(buffer), options.limits)) {
+        return std::unexpected(std::move(error.value()));
+    }
+
+    if (!buffer_owner && (options.lazy_headers || !options.decoded_headers.empty())) {
+        // raw header values are views into the buffer, which then has to live with the message
+        auto copy = std::make_shared<const std::vector<uint8_t>>(buffer.begin(), buffer.end());
+        const std::span<const uint8_t> data(*copy);
+        return read_message(data, options, std::move(copy));
+    }
+
+    return read_message(buffer, options, std::move(buffer_owner));
+}
+
+std::expected<message_ptr, parse_error> try_parse(const std::span<const uint8_t> buffer, const parse_options& options) {
+    return parse_buffer(buffer, options, nullptr);
+}
+
+message_ptr parse(shared_buffer buffer, const parse_options& options) {
+    auto result = try_parse(std::move(buffer), options);
+    if (!result) {
+        throw parse_exception(std::move(result.error()));
+    }
+
+    return std::move(result.value());
+}
+
+std::expected<message_ptr, parse_error> try_parse(shared_buffer buffer, const parse_options& options) {
+    const std::span<const uint8_t> data(*buffer);
+    return parse_buffer(data, options, std::move(buffer));
 }
 
 void write(std::ostream& os, message_ptr message) {
@@ -143,102 +285,180 @@ ssize_t write(const std::span<uint8_t> buffer, message_ptr message) {
     return os.tellp();
 }
 
+template<typename List, size_t... I>
+static std::array<List, sizeof...(I)> make_lists(std::pmr::memory_resource* resource, std::index_sequence<I...>) {
+    return {((void)I, List(resource))...};
+}
+
+header_container::header_container()
+    : m_arena()
+    , m_resource(std::pmr::get_default_resource())
+    , m_known_headers(make_lists<_header_list>(m_resource, std::make_index_sequence<headers::meta::_known_headers.size()>()))
+    , m_dynamic_headers(m_resource)
+{}
+
+header_container::header_container(std::unique_ptr<std::pmr::memory_resource> arena)
+    : m_arena(std::move(arena))
+    , m_resource(m_arena.get())
+    , m_known_headers(make_lists<_header_list>(m_resource, std::make_index_sequence<headers::meta::_known_headers.size()>()))
+    , m_dynamic_headers(m_resource)
+{}
+
 void header_container::add_headers(header_container&& other) {
-    for (auto& [name, holder] : other.m_headers) {
-        for (auto& header : holder) {
-            _add_header(name, std::move(header));
+    // headers allocated from the arena of the other container are released with it, so copy them
+    const auto add = [this, &other](headers::storage::_header_holder_ptr& holder) {
+        if (other.m_arena) {
+            _add_header(holder->copy(m_resource));
+        } else {
+            _add_header(std::move(holder));
+        }
+    };
+
+    for (auto& holders : other.m_known_headers) {
+        for (auto& holder : holders) {
+            add(holder);
+        }
+    }
+    for (auto& holders : other.m_dynamic_headers | std::views::values) {
+        for (auto& holder : holders) {
+            add(holder);
         }
     }
 }
 
-size_t header_container::_header_count(const std::string& name) const {
-    const auto it = m_headers.find(name);
-    if (it != m_headers.end()) {
-        return it->second.size();
+std::pmr::memory_resource* header_container::_resource() const {
+    return m_resource;
+}
+
+size_t header_container::_header_count(const size_t id, const std::string_view name) const {
+    const auto holders = _find_headers(id, name);
+    if (holders != nullptr) {
+        return holders->size();
     }
 
     return 0;
 }
 
-const headers::storage::_base_header_holder* header_container::_get_header(const std::string& name, const size_t index) const {
-    const auto it = m_headers.find(name);
-    if (it == m_headers.end()) {
-        throw headers::header_not_found();
-    }
-    if (it->second.empty()) {
+const headers::storage::_base_header_holder* header_container::_get_header(const size_t id, const std::string_view name, const size_t index) const {
+    const auto holders = _find_headers(id, name);
+    if (holders == nullptr) {
         throw headers::header_not_found();
     }
-    if (index >= it->second.size()) {
+    if (index >= holders->size()) {
         throw headers::header_not_found();
     }
 
-    return it->second[index].get();
+    return (*holders)[index].get();
 }
 
-headers::storage::_base_header_holder* header_container::_get_header(const std::string& name, const size_t index) {
-    const auto it = m_headers.find(name);
-    if (it == m_headers.end()) {
-        throw headers::header_not_found();
-    }
-    if (it->second.empty()) {
+headers::storage::_base_header_holder* header_container::_get_header(const size_t id, const std::string_view name, const size_t index) {
+    const auto holders = _find_headers(id, name);
+    if (holders == nullptr) {
         throw headers::header_not_found();
     }
-    if (index >= it->second.size()) {
+    if (index >= holders->size()) {
         throw headers::header_not_found();
     }
 
-    return it->second[index].get();
+    return (*holders)[index].get();
 }
 
-void header_container::_add_header(const std::string& name, headers::storage::_header_holder_ptr holder) {
-    const auto it = m_headers.find(name);
-    if (it == m_headers.end()) {
-        std::vector<headers::storage::_header_holder_ptr> vector;
-        vector.push_back(std::move(holder));
-        m_headers[name] = std::move(vector);
+void header_container::_add_header(headers::storage::_header_holder_ptr holder) {
+    const auto id = holder->id();
+    if (id < m_known_headers.size()) {
+        m_known_headers[id].push_back(std::move(holder));
+        return;
+    }
+
+    const std::string_view name = holder->name();
+    const auto it = m_dynamic_headers.find(name);
+    if (it == m_dynamic_headers.end()) {
+        _header_list holders(m_resource);
+        holders.push_back(std::move(holder));
+        m_dynamic_headers.emplace(name, std::move(holders));
     } else {
         it->second.push_back(std::move(holder));
     }
 }
 
-void header_container::_copy_headers(const std::string& name, const header_container& other) {
-    const auto it = other.m_headers.find(name);
-    if (it != other.m_headers.end()) {
-        for (const auto& holder : it->second) {
-            _add_header(name, holder->copy());
+void header_container::_copy_headers(const size_t id, const std::string_view name, const header_container& other) {
+    const auto holders = other._find_headers(id, name);
+    if (holders != nullptr) {
+        for (const auto& holder : *holders) {
+            _add_header(holder->copy(m_resource));
         }
     }
 }
 
-bool header_container::_remove_header(const std::string& name, const size_t index) {
-    const auto it = m_headers.find(name);
-    if (it == m_headers.end()) {
+bool header_container::_remove_header(const size_t id, const std::string_view name, const size_t index) {
+    const auto holders = _find_headers(id, name);
+    if (holders == nullptr) {
         return false;
     }
-    if (it->second.empty()) {
-        return false;
-    }
-    if (index >= it->second.size()) {
+    if (index >= holders->size()) {
         return false;
     }
 
-    it->second.erase(it->second.begin() + static_cast<ptrdiff_t>(index));
+    holders->erase(holders->begin() + static_cast<ptrdiff_t>(index));
     return true;
 }
 
-bool header_container::_remove_headers(const std::string& name) {
-    const auto it = m_headers.find(name);
-    if (it == m_headers.end()) {
+bool header_container::_remove_headers(const size_t id, const std::string_view name) {
+    const auto holders = _find_headers(id, name);
+    if (holders == nullptr) {
         return false;
     }
-    if (it->second.empty()) {
+    if (holders->empty()) {
         return false;
     }
 
-    it->second.clear();
+    holders->clear();
     return true;
 }
 
+void header_container::_clear_headers() {
+    for (auto& holders : m_known_headers) {
+        holders.clear();
+    }
+    // keep the entries, a message with the same headers is likely to come next
+    for (auto& holders : m_dynamic_headers | std::views::values) {
+        holders.clear();
+    }
+}
+
+const header_container::_header_list* header_container::_find_headers(const size_t id, const std::string_view name) const {
+    if (id < m_known_headers.size()) {
+        return &m_known_headers[id];
+    }
+
+    const auto it = m_dynamic_headers.find(name);
+    if (it == m_dynamic_headers.end()) {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+header_container::_header_list* header_container::_find_headers(const size_t id, const std::string_view name) {
+    if (id < m_known_headers.size()) {
+        return &m_known_headers[id];
+    }
+
+    const auto it = m_dynamic_headers.find(name);
+    if (it == m_dynamic_headers.end()) {
+        return nullptr;
+    }
+
+    return &it->second;
+}
+
+message::message(std::unique_ptr<std::pmr::memory_resource> arena)
+    : header_container(std::move(arena))
+    , m_request_line()
+    , m_status_line()
+    , m_body()
+{}
+
 bool message::is_valid() const {
     return is_request() || is_response();
 }
@@ -345,4 +565,11 @@ void message::_set_body(bodies::storage::_body_holder_ptr body) {
     m_body = std::move(body);
 }
 
+void message::_reset() {
+    _clear_headers();
+    m_request_line.reset();
+    m_status_line.reset();
+    m_body.reset();
+}
+
 }
@@ -0,0 +1,44 @@
+
+#include <sip/message_pool.h>
+
+namespace sippy::sip {
+
+message_pool::message_pool(const size_t max_size)
+    : m_max_size(max_size)
+    , m_free()
+{}
+
+message_ptr message_pool::acquire() {
+    if (m_free.empty()) {
+        return message_ptr(new message(), message_deleter(this));
+    }
+
+    auto msg = std::move(m_free.back());
+    m_free.pop_back();
+    return message_ptr(msg.release(), message_deleter(this));
+}
+
+size_t message_pool::size() const {
+    return m_free.size();
+}
+
+message_ptr make_message(message_pool* pool) {
+    if (pool != nullptr) {
+        return pool->acquire();
+    }
+
+    return std::make_unique<message>();
+}
+
+void message_pool::recycle(message* msg) {
+    std::unique_ptr<message> owned(msg);
+    // an arena only grows, so those are not worth keeping
+    if (m_free.size() >= m_max_size || owned->m_arena) {
+        return;
+    }
+
+    owned->_reset();
+    m_free.push_back(std::move(owned));
+}
+
+}
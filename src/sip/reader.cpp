@@ -1,112 +1,212 @@
 
-#include <regex>
 
 #include <sip/message.h>
+#include <sip/message_pool.h>
 
 #include "serialization/matchers.h"
+#include "serialization/scan.h"
+#include "util/string_helper.h"
 #include "types_storage.h"
 #include "reader.h"
 
 namespace sippy::sip {
 
-class bad_start_line final : public std::exception {
-public:
-    [[nodiscard]] const char *what() const noexcept override {
-        return "bad start line";
+parse_error_code to_parse_error_code(const serialization::read_error error) {
+    switch (error) {
+        case serialization::read_error::unexpected_character:
+            return parse_error_code::unexpected_character;
+        case serialization::read_error::not_enough_characters:
+            return parse_error_code::not_enough_characters;
+        case serialization::read_error::bad_number:
+            return parse_error_code::bad_number;
+        case serialization::read_error::unknown_value:
+            return parse_error_code::unknown_value;
+        case serialization::read_error::invalid_value:
+        default:
+            return parse_error_code::invalid_value;
     }
-};
+}
+
+void unfold_header_value(const std::string_view value, std::string& out) {
+    out.clear();
+
+    serialization::span_reader reader(value);
+    while (!reader.eof()) {
+        reader.eat_while<serialization::is_whitespace_or_tab>();
+        const auto line = reader.read_until_any("\r\n");
+        reader.eat_one_if<serialization::is_carriage_return>();
+        reader.eat_one_if<serialization::is_new_line>();
+
+        if (!out.empty()) {
+            out += ' ';
+        }
+        out += line;
+    }
+}
 
-class missing_header_value final : public std::exception {
-public:
-    [[nodiscard]] const char *what() const noexcept override {
-        return "missing header value";
+static void check_decoded(const headers::storage::_base_header_holder& holder, serialization::span_reader& reader, const std::string_view value) {
+    if (reader.failed()) {
+        const auto offset = static_cast<size_t>(reader.error_location() - value.data());
+        throw parse_exception({to_parse_error_code(reader.error()), offset, holder.name()});
     }
-};
 
-class header_value_trailing_data final : public std::exception {
-public:
-    [[nodiscard]] const char *what() const noexcept override {
-        return "trailing data in header";
+    reader.eat_while<serialization::is_whitespace>();
+    if (!reader.eof()) {
+        throw parse_exception({parse_error_code::header_value_trailing_data, reader.position(), holder.name()});
     }
-};
+}
+
+void decode_header_value(headers::storage::_base_header_holder& holder, const std::string_view value) {
+    serialization::span_reader reader(value);
+    holder.operator>>(reader);
+    check_decoded(holder, reader, value);
+}
+
+namespace headers::storage {
+
+void _decode(const _base_header_holder& holder) {
+    const auto value = holder.raw->view();
+    serialization::span_reader reader(value);
+    holder._decode_raw(reader);
+    check_decoded(holder, reader, value);
+}
 
-class body_trailing_data final : public std::exception {
-public:
-    [[nodiscard]] const char *what() const noexcept override {
-        return "trailing data in body";
+}
+
+static size_t count_header_values(const std::string_view value) {
+    size_t count = 0;
+    split_header_values(value, [&count](std::string_view) {
+        count++;
+    });
+
+    return count;
+}
+
+std::optional<parse_error> check_limits(const std::string_view buffer, const parse_limits& limits) {
+    if (limits.max_message_size > 0 && buffer.size() > limits.max_message_size) {
+        return parse_error{parse_error_code::message_too_large, limits.max_message_size, {}};
     }
-};
 
-class missing_content_type final : public std::exception {
-public:
-    [[nodiscard]] const char *what() const noexcept override {
-        return "missing content type";
+    // the rest takes a pass over the headers, which is skipped when there is nothing to check
+    if (limits.max_headers == 0 && limits.max_header_line == 0 && limits.max_via_entries == 0 &&
+        limits.max_contact_entries == 0 && limits.max_body_size == 0) {
+        return std::nullopt;
     }
-};
 
-class unknown_body final : public std::exception {
-public:
-    [[nodiscard]] const char *what() const noexcept override {
-        return "unknown body";
+    serialization::span_reader reader(buffer);
+    header_reader header_reader(reader);
+
+    const auto start_line = header_reader.read_start_line();
+    if (limits.max_header_line > 0 && start_line->size() > limits.max_header_line) {
+        return parse_error{parse_error_code::header_line_too_long, 0, {}};
     }
-};
 
-static void fixup_header_name(std::string& name) {
-    bool word_start = true;
-    for (char& ch : name) {
-        if (word_start) {
-            ch = static_cast<char>(std::toupper(ch));
-            word_start = false;
-        } else if (serialization::is_letter(ch)) {
-            ch = static_cast<char>(std::tolower(ch));
-        } else if (serialization::is_dash(ch)) {
-            word_start = true;
+    size_t headers = 0;
+    size_t via_entries = 0;
+    size_t contact_entries = 0;
+    while (!reader.failed()) {
+        const auto nameOpt = header_reader.read_header_name();
+        if (!nameOpt.has_value()) {
+            break;
+        }
+
+        const auto name = nameOpt.value();
+        const auto offset = static_cast<size_t>(name.data() - buffer.data());
+
+        bool folded;
+        const auto value = header_reader.read_raw_header_value(folded);
+
+        if (limits.max_headers > 0 && ++headers > limits.max_headers) {
+            return parse_error{parse_error_code::too_many_headers, offset, std::string(name)};
+        }
+
+        const auto line_size = static_cast<size_t>(value.data() + value.size() - name.data());
+        if (limits.max_header_line > 0 && line_size > limits.max_header_line) {
+            return parse_error{parse_error_code::header_line_too_long, offset, std::string(name)};
+        }
+
+        if (limits.max_via_entries > 0 && (util::equals_ignore_case(name, "Via") || util::equals_ignore_case(name, "v"))) {
+            via_entries += count_header_values(value);
+            if (via_entries > limits.max_via_entries) {
+                return parse_error{parse_error_code::too_many_header_values, offset, std::string(name)};
+            }
+        }
+        if (limits.max_contact_entries > 0 && (util::equals_ignore_case(name, "Contact") || util::equals_ignore_case(name, "m"))) {
+            contact_entries += count_header_values(value);
+            if (contact_entries > limits.max_contact_entries) {
+                return parse_error{parse_error_code::too_many_header_values, offset, std::string(name)};
+            }
         }
     }
+
+    // malformed messages are left for the parser to report
+    reader.eat("\r\n");
+    if (reader.failed()) {
+        return std::nullopt;
+    }
+
+    if (limits.max_body_size > 0 && reader.remaining() > limits.max_body_size) {
+        return parse_error{parse_error_code::body_too_large, reader.position(), {}};
+    }
+
+    return std::nullopt;
 }
 
-header_reader::header_reader(std::istream& is)
-    : m_reader(is)
+header_reader::header_reader(serialization::span_reader& reader)
+    : m_reader(reader)
+    , m_folded_value()
 {}
 
-std::optional<std::string> header_reader::read_start_line() {
-    auto data = m_reader.read_until(serialization::is_new_line);
+std::optional<std::string_view> header_reader::read_start_line() {
+    const auto data = m_reader.read_until_any("\r\n");
     eat_new_line();
 
-    return {std::move(data)};
+    return {data};
 }
 
-std::optional<std::string> header_reader::read_header_name() {
-    m_reader.eat_while(serialization::is_whitespace);
+std::optional<std::string_view> header_reader::read_header_name() {
+    m_reader.eat_while<serialization::is_whitespace>();
 
-    auto data = m_reader.read_while(serialization::is_letter_or_dash);
+    const auto data = m_reader.read_while<serialization::is_token>();
     if (data.empty()) {
         // empty line, so next is the body
         return std::nullopt;
     }
 
-    m_reader.eat_while(serialization::is_whitespace);
+    m_reader.eat_while<serialization::is_whitespace>();
     m_reader.eat(':');
 
-    return {std::move(data)};
+    return {data};
+}
+
+std::optional<std::string_view> header_reader::read_header_value() {
+    bool folded;
+    const auto data = read_raw_header_value(folded);
+    if (!folded) {
+        return {data};
+    }
+
+    // value continues on more lines, we can't point into the buffer anymore
+    unfold_header_value(data, m_folded_value);
+    return {m_folded_value};
 }
 
-std::optional<std::string> header_reader::read_header_value() {
-    m_reader.eat_while(serialization::is_whitespace_or_tab);
-    auto data = m_reader.read_until(serialization::is_new_line);
+std::string_view header_reader::read_raw_header_value(bool& folded) {
+    m_reader.eat_while<serialization::is_whitespace_or_tab>();
+    const auto data = m_reader.read_until_any("\r\n");
     eat_new_line();
 
-    // it is possible that next line is with more value
+    folded = false;
+    auto end = data.data() + data.size();
     while (m_reader.peek(' ') || m_reader.peek('\t')) {
-        // we have more data in the next line
-        m_reader.eat_while(serialization::is_whitespace_or_tab);
-        const auto more_data = m_reader.read_until(serialization::is_new_line);
+        const auto more_data = m_reader.read_until_any("\r\n");
         eat_new_line();
 
-        data += more_data;
+        folded = true;
+        end = more_data.data() + more_data.size();
     }
 
-    return {std::move(data)};
+    return {data.data(), static_cast<size_t>(end - data.data())};
 }
 
 void header_reader::eat_new_line() {
@@ -114,13 +214,26 @@ void header_reader::eat_new_line() {
     m_reader.eat('\n');
 }
 
-reader::reader(std::istream& is)
-    : m_is(is)
+reader::reader(const std::span<const uint8_t> buffer, const parse_options& options, std::shared_ptr<const void> buffer_owner)
+    : m_options(options)
+    , m_buffer(serialization::to_string_view(buffer))
+    , m_buffer_owner(std::move(buffer_owner))
+    , m_reader(buffer)
+    , m_header_reader(m_reader)
     , m_message()
+    , m_error()
+    , m_header_name()
+    , m_header_offset(0)
 {}
 
 void reader::reset() {
-    m_message = std::make_unique<message>();
+    if (m_options.arena) {
+        // sized from the message, so a typical message fits in the first block
+        auto arena = std::make_unique<std::pmr::monotonic_buffer_resource>(m_buffer.size() * 2);
+        m_message = std::make_unique<message>(std::move(arena));
+    } else {
+        m_message = make_message(m_options.pool);
+    }
 }
 
 message& reader::get() {
@@ -133,7 +246,7 @@ message_ptr reader::release() {
 
 void reader::parse_headers() {
     parse_start_line();
-    while (parse_next_header());
+    while (!failed() && parse_next_header());
 }
 
 bool reader::can_parse_body() {
@@ -142,122 +255,203 @@ bool reader::can_parse_body() {
         return true;
     }
 
-    const auto current_pos = m_is.tellg();
-    m_is.seekg(0, std::ios::end);
-    const auto end = m_is.tellg();
-    m_is.seekg(current_pos, std::ios::beg);
-
-    if ((end - current_pos) < len) {
-        return false;
-    }
-
-    return true;
+    // empty line is still pending before the body
+    return m_reader.remaining() >= len + 2;
 }
 
 void reader::parse_body() {
-    serialization::reader reader(m_is);
-    reader.eat("\r\n");
+    if (failed()) {
+        return;
+    }
+
+    m_reader.eat("\r\n");
 
     const auto len = get_body_length();
-    if (len < 1) {
+    if (failed() || len < 1) {
+        return;
+    }
+
+    const auto offset = m_reader.position();
+    const auto body = m_reader.read(len);
+    if (failed()) {
         return;
     }
 
-    auto body = reader.read(len);
     if (m_message->has_header<headers::content_type>()) {
         const auto& type = m_message->header<headers::content_type>().type;
-        load_body(type, std::move(body));
+        load_body(type, body, offset);
     } else {
-        throw missing_content_type();
+        fail(parse_error_code::missing_content_type, offset);
     }
 }
 
-void reader::parse_start_line() {
-    header_reader reader(m_is);
-    const auto lineOpt = reader.read_start_line();
-    if (!lineOpt.has_value()) {
-        throw bad_start_line();
+size_t reader::position() const {
+    return m_reader.position();
+}
+
+bool reader::failed() {
+    if (!m_error && m_reader.failed()) {
+        fail(m_reader);
+    }
+
+    return m_error.has_value();
+}
+
+parse_error reader::release_error() {
+    return std::move(m_error.value());
+}
+
+void reader::fail(const parse_error_code code, const size_t offset) {
+    if (!m_error) {
+        m_error = parse_error{code, offset, std::string(m_header_name)};
     }
+}
 
-    const auto& str = lineOpt.value();
+void reader::fail(const serialization::span_reader& reader) {
+    fail(to_parse_error_code(reader.error()), offset_of(reader.error_location()));
+}
 
-    const std::regex pattern(R"(^(?:(?:(\w+)\s(.+)\sSIP\/(2\.0))|(?:SIP\/(2\.0)\s(\d+)\s(.+)))$)");
-    std::smatch match;
-    if (!std::regex_match(str, match, pattern)) {
-        throw bad_start_line();
+size_t reader::offset_of(const char* location) const {
+    if (location >= m_buffer.data() && location <= m_buffer.data() + m_buffer.size()) {
+        return location - m_buffer.data();
     }
 
-    if (match[1].matched && match[2].matched && match[3].matched) {
-        // request
-        std::stringstream ss(str);
+    // folded header values are copied out of the buffer
+    return m_header_offset;
+}
 
-        sip::request_line request_line;
-        ss >> request_line;
-        m_message->set_request_line(std::move(request_line));
-    } else if (match[4].matched && match[5].matched && match[6].matched) {
-        // status
-        std::stringstream ss(str);
+void reader::parse_start_line() {
+    const auto lineOpt = m_header_reader.read_start_line();
+    if (failed()) {
+        return;
+    }
+    if (!lineOpt.has_value()) {
+        fail(parse_error_code::bad_start_line, 0);
+        return;
+    }
+
+    const auto line = lineOpt.value();
+    serialization::span_reader reader(line);
 
+    if (line.starts_with("SIP/")) {
+        // SIP-Version SP Status-Code SP Reason-Phrase
         sip::status_line status_line;
-        ss >> status_line;
+        reader >> status_line.version;
+        reader.eat(' ');
+        reader >> status_line.code;
+        reader.eat(' ');
+        status_line.reason_phrase = reader.read(reader.remaining());
+
+        if (reader.failed()) {
+            fail(parse_error_code::bad_start_line, offset_of(reader.error_location()));
+            return;
+        }
+
         m_message->set_status_line(std::move(status_line));
     } else {
-        throw bad_start_line();
+        // Method SP Request-URI SP SIP-Version
+        sip::request_line request_line;
+        reader >> request_line.method;
+        reader.eat(' ');
+        request_line.uri = reader.read_until<serialization::is_whitespace>();
+        if (request_line.uri.empty()) {
+            reader.fail(serialization::read_error::unexpected_character);
+        }
+        reader.eat(' ');
+        reader >> request_line.version;
+
+        if (!reader.failed() && !reader.eof()) {
+            reader.fail(serialization::read_error::unexpected_character);
+        }
+        if (reader.failed()) {
+            fail(parse_error_code::bad_start_line, offset_of(reader.error_location()));
+            return;
+        }
+
+        m_message->set_request_line(std::move(request_line));
     }
 }
 
 bool reader::parse_next_header() {
-    header_reader header_reader(m_is);
-    auto nameOpt = header_reader.read_header_name();
+    const auto nameOpt = m_header_reader.read_header_name();
     if (!nameOpt.has_value()) {
         return false;
     }
-    auto& name = nameOpt.value();
+    const auto name = nameOpt.value();
+    m_header_name = name;
+    m_header_offset = m_reader.position();
 
-    auto valueOpt = header_reader.read_header_value();
+    const auto valueOpt = m_header_reader.read_header_value();
+    if (failed()) {
+        return false;
+    }
     if (!valueOpt.has_value()) {
-        throw missing_header_value();
+        fail(parse_error_code::missing_header_value, m_header_offset);
+        return false;
     }
-    auto& value = valueOpt.value();
+    const auto value = valueOpt.value();
 
-    load_header_values(name, std::move(value));
+    load_header_values(name, value);
+    m_header_name = {};
 
-    return true;
+    return !failed();
 }
 
-void reader::load_header_values(const std::string& name, std::string&& value) {
-    const auto defOpt = headers::storage::get_header(name);
-    if (!defOpt.has_value()) {
+void reader::load_header_values(const std::string_view name, const std::string_view value) {
+    const auto def = headers::storage::get_header(name);
+    if (def == nullptr) {
         // unknown header, ignore it
         return;
     }
 
-    const auto& def = defOpt.value();
+    if (!m_options.should_decode(def->id())) {
+        load_raw_header_values(*def, value);
+        return;
+    }
+
     const auto can_multiple = (def->flags() & headers::flag_allow_multiple) != 0;
 
-    std::stringstream ss(std::move(value));
-    serialization::reader reader(ss);
+    serialization::span_reader reader(value);
     do {
-        reader.eat_while(serialization::is_whitespace);
+        reader.eat_while<serialization::is_whitespace>();
 
-        auto holder = def->create();
-        holder->operator>>(ss);
-        m_message->_add_header(name, std::move(holder));
+        auto holder = def->create(m_message->_resource());
+        holder->operator>>(reader);
+        if (reader.failed()) {
+            fail(reader);
+            return;
+        }
+        m_message->_add_header(std::move(holder));
 
-        reader.eat_while(serialization::is_whitespace);
+        reader.eat_while<serialization::is_whitespace>();
 
-        if (!ss.eof()) {
+        if (!reader.eof()) {
             if (!can_multiple || !reader.peek(',')) {
-                throw header_value_trailing_data();
+                fail(parse_error_code::header_value_trailing_data, offset_of(value.data() + reader.position()));
+                return;
             }
 
             // more header values
             reader.eat(',');
-            reader.eat_while(serialization::is_whitespace);
+            reader.eat_while<serialization::is_whitespace>();
 
             // next loop run will parse the header
         }
-    } while (!ss.eof());
+    } while (!reader.eof());
+}
+
+void reader::load_raw_header_values(const headers::storage::_base_header_def& def, const std::string_view value) {
+    const auto add_raw = [this, &def](const std::string_view raw) {
+        auto holder = def.create(m_message->_resource());
+        holder->raw.emplace(util::trim_whitespace(raw), m_buffer_owner);
+        m_message->_add_header(std::move(holder));
+    };
+
+    if ((def.flags() & headers::flag_allow_multiple) != 0) {
+        split_header_values(value, add_raw);
+    } else {
+        add_raw(value);
+    }
 }
 
 uint32_t reader::get_body_length() const {
@@ -269,21 +463,25 @@ uint32_t reader::get_body_length() const {
     return m_message->header<headers::content_length>().length;
 }
 
-void reader::load_body(const std::string& type, std::string&& value) {
-    const auto defOpt = bodies::storage::get_body(type);
-    if (!defOpt.has_value()) {
-        throw unknown_body();
+void reader::load_body(const std::string& type, const std::string_view value, const size_t offset) {
+    const auto def = bodies::storage::get_body(type);
+    if (def == nullptr) {
+        fail(parse_error_code::unknown_body, offset);
+        return;
     }
 
-    const auto& def = defOpt.value();
-
-    std::stringstream ss(std::move(value));
+    serialization::span_reader reader(value);
 
-    auto holder = def->create();
-    holder->operator>>(ss);
+    auto holder = def->create(m_message->_resource());
+    holder->operator>>(reader);
+    if (reader.failed()) {
+        fail(parse_error_code::bad_body, offset);
+        return;
+    }
 
-    if (!ss.eof()) {
-        throw body_trailing_data();
+    if (!reader.eof()) {
+        fail(parse_error_code::body_trailing_data, offset + reader.position());
+        return;
     }
 
     m_message->_set_body(std::move(holder));
@@ -4,27 +4,45 @@
 
 #include <sip/message.h>
 
-#include "serialization/reader.h"
+#include "serialization/scan.h"
+#include "serialization/span_reader.h"
 
 namespace sippy::sip {
 
 class header_reader {
 public:
-    explicit header_reader(std::istream& is);
+    explicit header_reader(serialization::span_reader& reader);
 
-    std::optional<std::string> read_start_line();
-    std::optional<std::string> read_header_name();
-    std::optional<std::string> read_header_value();
+    std::optional<std::string_view> read_start_line();
+    std::optional<std::string_view> read_header_name();
+    std::optional<std::string_view> read_header_value();
+    // the value as it is in the buffer, continuation lines included
+    std::string_view read_raw_header_value(bool& folded);
 
 private:
     void eat_new_line();
 
-    serialization::reader m_reader;
+    serialization::span_reader& m_reader;
+    std::string m_folded_value;
 };
 
+parse_error_code to_parse_error_code(serialization::read_error error);
+
+// values are separated by commas, unless inside a quoted string or <uri>
+template<typename callback>
+void split_header_values(std::string_view value, callback&& cb);
+// joins the lines of a folded value with a single space
+void unfold_header_value(std::string_view value, std::string& out);
+
+// a quick pass over the header lines, before the message is parsed
+std::optional<parse_error> check_limits(std::string_view buffer, const parse_limits& limits);
+
+void decode_header_value(headers::storage::_base_header_holder& holder, std::string_view value);
+
 class reader {
 public:
-    explicit reader(std::istream& is);
+    // header values kept raw point into the buffer, so it needs an owner to keep them alive
+    reader(std::span<const uint8_t> buffer, const parse_options& options, std::shared_ptr<const void> buffer_owner = {});
 
     void reset();
     message& get();
@@ -34,18 +52,72 @@ public:
     bool can_parse_body();
     void parse_body();
 
+    [[nodiscard]] size_t position() const;
+
+    [[nodiscard]] bool failed();
+    parse_error release_error();
+
 private:
+    void fail(parse_error_code code, size_t offset);
+    void fail(const serialization::span_reader& reader);
+    [[nodiscard]] size_t offset_of(const char* location) const;
+
     void parse_start_line();
     bool parse_next_header();
 
-    void load_header_values(const std::string& name, std::string&& value);
+    void load_header_values(std::string_view name, std::string_view value);
+    void load_raw_header_values(const headers::storage::_base_header_def& def, std::string_view value);
 
     [[nodiscard]] uint32_t get_body_length() const;
-    void load_body(const std::string& type, std::string&& value);
+    void load_body(const std::string& type, std::string_view value, size_t offset);
 
-    std::istream& m_is;
+    const parse_options& m_options;
+    std::string_view m_buffer;
+    std::shared_ptr<const void> m_buffer_owner;
+    serialization::span_reader m_reader;
+    header_reader m_header_reader;
     message_ptr m_message;
-
+    std::optional<parse_error> m_error;
+    std::string_view m_header_name;
+    size_t m_header_offset;
 };
 
+template<typename callback>
+void split_header_values(const std::string_view value, callback&& cb) {
+    static constexpr serialization::delimiter_set quoted_delimiters = "\"\\";
+    static constexpr serialization::delimiter_set value_delimiters = ",\"<>";
+
+    const auto end = value.data() + value.size();
+    bool in_quotes = false;
+    bool in_uri = false;
+    auto start = value.data();
+    auto ptr = value.data();
+    while (true) {
+        ptr = serialization::find_first_of(ptr, end, in_quotes ? quoted_delimiters : value_delimiters);
+        if (ptr >= end) {
+            break;
+        }
+
+        const auto ch = *ptr++;
+        if (in_quotes) {
+            if (ch == '\\') {
+                ptr++;
+            } else {
+                in_quotes = false;
+            }
+        } else if (ch == '"') {
+            in_quotes = true;
+        } else if (ch == '<') {
+            in_uri = true;
+        } else if (ch == '>') {
+            in_uri = false;
+        } else if (!in_uri) {
+            cb(std::string_view(start, ptr - 1 - start));
+            start = ptr;
+        }
+    }
+
+    cb(std::string_view(start, end - start));
+}
+
 }
@@ -40,8 +40,9 @@ message_ptr create_request(
     const std::string_view call_id,
     const uint32_t sequence_num,
     const uint32_t expires,
-    const uint32_t max_forwards) {
-    auto msg = std::make_unique<sip::message>();
+    const uint32_t max_forwards,
+    message_pool* pool) {
+    auto msg = make_message(pool);
 
     {
         request_line line;
@@ -91,7 +92,8 @@ message_ptr create_request_register(
     const std::string_view call_id,
     const uint32_t sequence_num,
     const uint32_t expires,
-    const uint32_t max_forwards) {
+    const uint32_t max_forwards,
+    message_pool* pool) {
     return create_request(
         sip::method::register_,
         target_uri,
@@ -100,7 +102,8 @@ message_ptr create_request_register(
         call_id,
         sequence_num,
         expires,
-        max_forwards);
+        max_forwards,
+        pool);
 }
 
 headers::authorization create_request_authorization(
@@ -8,8 +8,9 @@ message_ptr create_response(
     const sip::message& original_request,
     const uint32_t expires,
     const uint32_t max_forwards,
-    const std::optional<std::string_view> phrase) {
-    auto msg = std::make_unique<sip::message>();
+    const std::optional<std::string_view> phrase,
+    message_pool* pool) {
+    auto msg = make_message(pool);
 
     {
         status_line line;
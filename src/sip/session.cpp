@@ -38,7 +38,7 @@ static std::optional<std::string> get_branch(const message_ptr& msg, const conne
         if (header.port == conn_info.local_port && header.host == conn_info.local_address) {
             auto it = header.tags.find("branch");
             if (it != header.tags.end()) {
-                return it->second;
+                return it->second.value;
             }
         }
     }
@@ -80,10 +80,10 @@ void transaction::respond(const status_code code) {
 }
 
 void transaction::send(message_ptr&& message) {
-    auto& from = message->header<headers::from>();
+    auto& from = message->mutable_header<headers::from>();
     from.tag = message->is_request() ? m_info.dialog.local_tag : m_info.dialog.remote_tag;
 
-    auto& to = message->header<headers::to>();
+    auto& to = message->mutable_header<headers::to>();
     to.tag = message->is_request() ? m_info.dialog.remote_tag : m_info.dialog.local_tag;
 
     {
@@ -209,7 +209,7 @@ void dialog::request(message_ptr&& message, response_callback&& callback) {
 
     const auto seq_num = next_sequence_number();
     if (message->has_header<headers::cseq>()) {
-        auto& cseq = message->header<headers::cseq>();
+        auto& cseq = message->mutable_header<headers::cseq>();
         cseq.method = message->request_line().method;
         cseq.seq_num = seq_num;
     } else {
@@ -0,0 +1,225 @@
+
+#include <exception>
+
+#include <sip/stream_parser.h>
+
+#include "serialization/matchers.h"
+#include "serialization/numbers.h"
+#include "serialization/scan.h"
+#include "serialization/span_reader.h"
+#include "util/string_helper.h"
+
+namespace sippy::sip {
+
+static constexpr std::string_view headers_end = "\r\n\r\n";
+
+static size_t find_headers_end(const std::string_view data, const size_t from) {
+    const auto end = data.data() + data.size();
+    auto ptr = data.data() + from;
+    while ((ptr = serialization::find_first_of(ptr, end, "\r")) < end) {
+        if (std::string_view(ptr, end - ptr).starts_with(headers_end)) {
+            return ptr - data.data();
+        }
+        ++ptr;
+    }
+
+    return std::string_view::npos;
+}
+
+static bool exceeds(const size_t limit, const size_t size) {
+    return limit > 0 && size > limit;
+}
+
+static std::optional<uint32_t> find_content_length(const std::string_view headers) {
+    // skip the start line, it is never a header
+    auto pos = headers.find("\r\n");
+    while (pos != std::string_view::npos && pos < headers.size()) {
+        pos += 2;
+
+        const auto line_end = headers.find("\r\n", pos);
+        const auto line = headers.substr(pos, line_end - pos);
+        pos = line_end;
+
+        serialization::span_reader reader(line);
+        reader.eat_while<serialization::is_whitespace>();
+        const auto name = reader.read_while<serialization::is_letter_or_dash>();
+        if (!util::equals_ignore_case(name, "Content-Length") && !util::equals_ignore_case(name, "l")) {
+            continue;
+        }
+
+        reader.eat_while<serialization::is_whitespace_or_tab>();
+        if (!reader.eat_one_if<serialization::is_colon>()) {
+            continue;
+        }
+        reader.eat_while<serialization::is_whitespace_or_tab>();
+
+        const auto value = reader.read_while<serialization::is_number>();
+        reader.eat_while<serialization::is_whitespace_or_tab>();
+        if (value.empty() || !reader.eof()) {
+            return std::nullopt;
+        }
+
+        return serialization::parse_number<uint32_t>(value);
+    }
+
+    // stream transports must send content length, treat a missing one as no body
+    return 0;
+}
+
+stream_parser::stream_parser(const parse_options options)
+    : m_options(options)
+    , m_buffer()
+    , m_scanned(0)
+    , m_frame_size(0)
+{}
+
+void stream_parser::feed(const std::span<const uint8_t> data, const message_callback& callback, const error_callback& on_error) {
+    auto buffer = data;
+    if (!m_buffer.empty()) {
+        m_buffer.insert(m_buffer.end(), data.begin(), data.end());
+        buffer = m_buffer;
+    }
+
+    const auto report = [&on_error](const parse_error& error) {
+        if (on_error) {
+            on_error(error);
+        }
+    };
+
+    size_t offset = 0;
+    std::exception_ptr callback_error;
+    while (true) {
+        const auto frame = next_frame(buffer, offset);
+        if (!frame) {
+            report(frame.error());
+            continue;
+        }
+        if (!frame->has_value()) {
+            break;
+        }
+
+        auto message = try_parse(frame->value(), m_options);
+        if (!message) {
+            report(message.error());
+            continue;
+        }
+
+        try {
+            callback(std::move(message.value()));
+        } catch (...) {
+            // keep delivering the messages after it, they would otherwise wait for more data
+            if (!callback_error) {
+                callback_error = std::current_exception();
+            }
+        }
+    }
+
+    keep_remaining(buffer, offset);
+    if (callback_error) {
+        std::rethrow_exception(callback_error);
+    }
+}
+
+void stream_parser::reset() {
+    m_buffer.clear();
+    m_scanned = 0;
+    m_frame_size = 0;
+}
+
+size_t stream_parser::pending() const {
+    return m_buffer.size();
+}
+
+std::expected<std::optional<std::span<const uint8_t>>, parse_error> stream_parser::next_frame(const std::span<const uint8_t> buffer, size_t& offset) {
+    const auto data = serialization::to_string_view(buffer);
+
+    if (m_frame_size == 0) {
+        if (m_scanned == 0) {
+            // keep-alive line breaks between messages
+            while (offset < data.size() && serialization::is_new_line(data[offset])) {
+                offset++;
+            }
+        }
+
+        const auto message = data.substr(offset);
+        const auto search_from = m_scanned > headers_end.size() ? m_scanned - headers_end.size() : 0;
+        const auto end = find_headers_end(message, search_from);
+        if (end == std::string_view::npos) {
+            m_scanned = message.size();
+            if (exceeds(m_options.limits.max_message_size, m_scanned)) {
+                drop(data, offset);
+                return std::unexpected(parse_error{parse_error_code::message_too_large, m_options.limits.max_message_size, {}});
+            }
+
+            return std::nullopt;
+        }
+
+        const auto length = find_content_length(message.substr(0, end));
+        if (!length.has_value()) {
+            // no way to find where the next message starts, drop everything
+            drop(data, offset);
+            return std::unexpected(parse_error{parse_error_code::bad_content_length, 0, "Content-Length"});
+        }
+
+        const auto frame_size = end + headers_end.size() + length.value();
+        if (exceeds(m_options.limits.max_body_size, length.value())) {
+            drop(data, offset);
+            return std::unexpected(parse_error{parse_error_code::body_too_large, end + headers_end.size(), {}});
+        }
+        if (exceeds(m_options.limits.max_message_size, frame_size)) {
+            drop(data, offset);
+            return std::unexpected(parse_error{parse_error_code::message_too_large, m_options.limits.max_message_size, {}});
+        }
+
+        m_frame_size = frame_size;
+    }
+
+    if (data.size() - offset < m_frame_size) {
+        return std::nullopt;
+    }
+
+    const auto frame = buffer.subspan(offset, m_frame_size);
+    offset += m_frame_size;
+    m_frame_size = 0;
+    m_scanned = 0;
+
+    return frame;
+}
+
+parse_many_result parse_many(const std::span<const uint8_t> buffer, const parse_options& options) {
+    parse_many_result result;
+
+    stream_parser parser(options);
+    size_t offset = 0;
+    while (true) {
+        const auto frame = parser.next_frame(buffer, offset);
+        if (!frame) {
+            // nothing after it can be framed
+            result.messages.push_back(std::unexpected(frame.error()));
+            break;
+        }
+        if (!frame->has_value()) {
+            break;
+        }
+
+        result.messages.push_back(try_parse(frame->value(), options));
+    }
+
+    result.remaining = buffer.subspan(offset);
+    return result;
+}
+
+void stream_parser::drop(const std::string_view data, size_t& offset) {
+    offset = data.size();
+    m_scanned = 0;
+}
+
+void stream_parser::keep_remaining(const std::span<const uint8_t> buffer, const size_t offset) {
+    if (!m_buffer.empty() && buffer.data() == m_buffer.data()) {
+        m_buffer.erase(m_buffer.begin(), m_buffer.begin() + static_cast<ptrdiff_t>(offset));
+    } else {
+        m_buffer.assign(buffer.begin() + static_cast<ptrdiff_t>(offset), buffer.end());
+    }
+}
+
+}
@@ -5,6 +5,7 @@ namespace sippy::sip {
 
 tcp_channel::tcp_channel(const looper::tcp tcp)
     : m_tcp(tcp)
+    , m_parser()
     , m_read_callback()
     , m_error_callback()
 {}
@@ -29,8 +30,9 @@ void tcp_channel::start_read() {
         if (error != 0) {
             m_error_callback(error);
         } else {
-            auto msg = parse(data);
-            m_read_callback(std::move(msg));
+            m_parser.feed(data, m_read_callback, [this](const parse_error& parse_error)-> void {
+                m_error_callback(channel::parse_error_base + static_cast<uint64_t>(parse_error.code));
+            });
         }
     });
 }
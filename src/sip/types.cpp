@@ -1,10 +1,14 @@
 
 #include <exception>
 #include <cstdint>
-#include <map>
+#include <array>
+#include <utility>
 
 #include <sip/types.h>
+#include "serialization/enum_codec.h"
+#include "serialization/numbers.h"
 #include "serialization/reader.h"
+#include "serialization/span_reader.h"
 
 namespace sippy::sip {
 
@@ -50,51 +54,139 @@ public:
     }
 };
 
-std::map<std::string, method, std::less<>> m_str_to_method = {
-    {"INVITE", method::invite},
-    {"ACK", method::ack},
-    {"BYE", method::bye},
-    {"CANCEL", method::cancel},
-    {"UPDATE", method::update},
-    {"INFO", method::info},
-    {"SUBSCRIBE", method::subscribe},
-    {"NOTIFY", method::notify},
-    {"REFER", method::refer},
-    {"MESSAGE", method::message},
-    {"OPTIONS", method::options},
-    {"REGISTER", method::register_},
-};
-std::map<std::string, version, std::less<>> m_str_to_version = {
-    {"2.0", version::version_2_0}
-};
-std::map<std::string, transport, std::less<>> m_str_to_transport = {
-    {"TCP", transport::tcp},
-    {"UDP", transport::udp}
-};
-std::map<std::string, auth_scheme, std::less<>> m_str_to_authscheme = {
-    {"Digest", auth_scheme::digest}
-};
-std::map<std::string, auth_algorithm, std::less<>> m_str_to_authalgorithm = {
-    {"AKAv1-MD5", auth_algorithm::aka},
-    {"MD5", auth_algorithm::md5}
+static constexpr auto method_codec = serialization::make_enum_codec<method>({
+    "INVITE",
+    "ACK",
+    "BYE",
+    "CANCEL",
+    "UPDATE",
+    "INFO",
+    "SUBSCRIBE",
+    "NOTIFY",
+    "REFER",
+    "MESSAGE",
+    "OPTIONS",
+    "REGISTER",
+});
+static constexpr auto version_codec = serialization::make_enum_codec<version>({
+    "2.0"
+});
+static constexpr auto transport_codec = serialization::make_enum_codec<transport>({
+    "TCP",
+    "UDP"
+});
+static constexpr auto auth_scheme_codec = serialization::make_enum_codec<auth_scheme>({
+    "Digest"
+});
+static constexpr auto auth_algorithm_codec = serialization::make_enum_codec<auth_algorithm>({
+    "AKAv1-MD5",
+    "MD5"
+});
+
+static constexpr uint16_t min_status_code = 100;
+static constexpr uint16_t max_status_code = 699;
+
+struct reason_phrase_entry {
+    status_code code;
+    const char* phrase;
 };
 
-std::optional<method> try_get_method(const std::string_view str) {
-    const auto it = m_str_to_method.find(str);
-    if (it != m_str_to_method.end()) {
-        return it->second;
-    } else {
-        return std::nullopt;
+// indexed by code - min_status_code, nullptr for codes which are not defined
+static constexpr auto reason_phrases = [] {
+    constexpr reason_phrase_entry entries[] = {
+        {status_code::trying, "TRYING"},
+        {status_code::ringing, "RINGING"},
+        {status_code::call_being_forwarded, "CALL BEING FORWARDED"},
+        {status_code::queued, "QUEUED"},
+        {status_code::session_progress, "SESSION PROGRESS"},
+        {status_code::early_dialog_terminated, "EARLY DIALOG TERMINATED"},
+        {status_code::ok, "OK"},
+        {status_code::accepted, "ACCEPTED"},
+        {status_code::no_notification, "NO NOTIFICATION"},
+        {status_code::multiple_choices, "MULTIPLE CHOICES"},
+        {status_code::moved_permanently, "MOVED PERMANENTLY"},
+        {status_code::moved_temporarily, "MOVED TEMPORARILY"},
+        {status_code::use_proxy, "USE PROXY"},
+        {status_code::alternative_service, "ALTERNATIVE SERVICE"},
+        {status_code::bad_request, "BAD REQUEST"},
+        {status_code::unauthorized, "UNAUTHORIZED"},
+        {status_code::payment_required, "PAYMENT REQUIRED"},
+        {status_code::forbidden, "FORBIDDEN"},
+        {status_code::not_found, "NOT FOUND"},
+        {status_code::method_not_allowed, "METHOD NOT ALLOWED"},
+        {status_code::not_acceptable, "NOT ACCEPTABLE"},
+        {status_code::proxy_authentication_required, "PROXY AUTHENTICATION REQUIRED"},
+        {status_code::request_timeout, "REQUEST TIMEOUT"},
+        {status_code::conflict, "CONFLICT"},
+        {status_code::gone, "GONE"},
+        {status_code::length_required, "LENGTH REQUIRED"},
+        {status_code::conditional_request_failed, "CONDITIONAL REQUEST FAILED"},
+        {status_code::request_entity_too_large, "REQUEST ENTITY TOO LARGE"},
+        {status_code::request_uri_too_long, "REQUEST URI TOO LONG"},
+        {status_code::unsupported_media_type, "UNSUPPORTED MEDIA TYPE"},
+        {status_code::unsupported_uri_scheme, "UNSUPPORTED URI SCHEME"},
+        {status_code::unknown_resource_priority, "UNKNOWN RESOURCE PRIORITY"},
+        {status_code::bad_extension, "BAD EXTENSION"},
+        {status_code::extension_required, "EXTENSION REQUIRED"},
+        {status_code::session_interval_too_small, "SESSION INTERVAL TOO SMALL"},
+        {status_code::interval_too_brief, "INTERVAL TOO BRIEF"},
+        {status_code::bad_location_information, "BAD LOCATION INFORMATION"},
+        {status_code::bad_alert_information, "BAD ALERT INFORMATION"},
+        {status_code::use_identity_header, "USE IDENTITY HEADER"},
+        {status_code::provide_referrer_identity, "PROVIDE REFERRER IDENTITY"},
+        {status_code::flow_failed, "FLOW FAILED"},
+        {status_code::anonymity_disallowed, "ANONYMITY DISALLOWED"},
+        {status_code::bad_identity_info, "BAD IDENTITY INFO"},
+        {status_code::unsupported_certificate, "UNSUPPORTED CERTIFICATE"},
+        {status_code::invalid_identity_header, "INVALID IDENTITY HEADER"},
+        {status_code::first_hop_lacks_outbound_support, "FIRST HOP LACKS OUTBOUND SUPPORT"},
+        {status_code::max_breadth_exceeded, "MAX BREADTH EXCEEDED"},
+        {status_code::bad_info_package, "BAD INFO PACKAGE"},
+        {status_code::consent_needed, "CONSENT NEEDED"},
+        {status_code::temporarily_unavailable, "TEMPORARILY UNAVAILABLE"},
+        {status_code::call_transaction_does_not_exist, "CALL TRANSACTION DOES NOT EXIST"},
+        {status_code::loop_detected, "LOOP DETECTED"},
+        {status_code::too_many_hops, "TOO MANY HOPS"},
+        {status_code::address_incomplete, "ADDRESS INCOMPLETE"},
+        {status_code::ambiguous, "AMBIGUOUS"},
+        {status_code::busy_here, "BUSY HERE"},
+        {status_code::request_terminated, "REQUEST TERMINATED"},
+        {status_code::not_acceptable_here, "NOT ACCEPTABLE HERE"},
+        {status_code::bad_event, "BAD EVENT"},
+        {status_code::request_pending, "REQUEST PENDING"},
+        {status_code::undecipherable, "UNDECIPHERABLE"},
+        {status_code::security_agreement_required, "SECURITY AGREEMENT REQUIRED"},
+        {status_code::internal_server_error, "INTERNAL SERVER ERROR"},
+        {status_code::not_implemented, "NOT IMPLEMENTED"},
+        {status_code::bad_gateway, "BAD GATEWAY"},
+        {status_code::service_unavailable, "SERVICE UNAVAILABLE"},
+        {status_code::server_timeout, "SERVER TIMEOUT"},
+        {status_code::version_not_supported, "VERSION NOT SUPPORTED"},
+        {status_code::message_too_large, "MESSAGE TOO LARGE"},
+        {status_code::push_notification_not_supported, "PUSH NOTIFICATION NOT SUPPORTED"},
+        {status_code::precondition_failure, "PRECONDITION FAILURE"},
+        {status_code::busy_everywhere, "BUSY EVERYWHERE"},
+        {status_code::decline, "DECLINE"},
+        {status_code::does_not_exist_anywhere, "DOES NOT EXIST ANYWHERE"},
+        {status_code::not_acceptable_global, "NOT ACCEPTABLE GLOBAL"},
+        {status_code::unwanted, "UNWANTED"},
+        {status_code::rejected, "REJECTED"},
+    };
+
+    std::array<const char*, max_status_code - min_status_code + 1> table{};
+    for (const auto& [code, phrase] : entries) {
+        table[static_cast<uint16_t>(code) - min_status_code] = phrase;
     }
+
+    return table;
+}();
+
+std::optional<method> try_get_method(const std::string_view str) {
+    return method_codec.decode(str);
 }
 
 std::optional<version> try_get_version(const std::string_view str) {
-    const auto it = m_str_to_version.find(str);
-    if (it != m_str_to_version.end()) {
-        return it->second;
-    } else {
-        return std::nullopt;
-    }
+    return version_codec.decode(str);
 }
 
 status_class get_class(const status_code code) {
@@ -122,184 +214,45 @@ status_class get_class(const status_code code) {
 }
 
 const char* status_code_reason_phrase(const status_code code) {
-    switch (code) {
-        case status_code::trying:
-            return "TRYING";
-        case status_code::ringing:
-            return "RINGING";
-        case status_code::call_being_forwarded:
-            return "CALL BEING FORWARDED";
-        case status_code::queued:
-            return "QUEUED";
-        case status_code::session_progress:
-            return "SESSION PROGRESS";
-        case status_code::early_dialog_terminated:
-            return "EARLY DIALOG TERMINATED";
-        case status_code::ok:
-            return "OK";
-        case status_code::accepted:
-            return "ACCEPTED";
-        case status_code::no_notification:
-            return "NO NOTIFICATION";
-        case status_code::multiple_choices:
-            return "MULTIPLE CHOICES";
-        case status_code::moved_permanently:
-            return "MOVED PERMANENTLY";
-        case status_code::moved_temporarily:
-            return "MOVED TEMPORARILY";
-        case status_code::use_proxy:
-            return "USE PROXY";
-        case status_code::alternative_service:
-            return "ALTERNATIVE SERVICE";
-        case status_code::bad_request:
-            return "BAD REQUEST";
-        case status_code::unauthorized:
-            return "UNAUTHORIZED";
-        case status_code::payment_required:
-            return "PAYMENT REQUIRED";
-        case status_code::forbidden:
-            return "FORBIDDEN";
-        case status_code::not_found:
-            return "NOT FOUND";
-        case status_code::method_not_allowed:
-            return "METHOD NOT ALLOWED";
-        case status_code::not_acceptable:
-            return "NOT ACCEPTABLE";
-        case status_code::proxy_authentication_required:
-            return "PROXY AUTHENTICATION REQUIRED";
-        case status_code::request_timeout:
-            return "REQUEST TIMEOUT";
-        case status_code::conflict:
-            return "CONFLICT";
-        case status_code::gone:
-            return "GONE";
-        case status_code::length_required:
-            return "LENGTH REQUIRED";
-        case status_code::conditional_request_failed:
-            return "CONDITIONAL REQUEST FAILED";
-        case status_code::request_entity_too_large:
-            return "REQUEST ENTITY TOO LARGE";
-        case status_code::request_uri_too_long:
-            return "REQUEST URI TOO LONG";
-        case status_code::unsupported_media_type:
-            return "UNSUPPORTED MEDIA TYPE";
-        case status_code::unsupported_uri_scheme:
-            return "UNSUPPORTED URI SCHEME";
-        case status_code::unknown_resource_priority:
-            return "UNKNOWN RESOURCE PRIORITY";
-        case status_code::bad_extension:
-            return "BAD EXTENSION";
-        case status_code::extension_required:
-            return "EXTENSION REQUIRED";
-        case status_code::session_interval_too_small:
-            return "SESSION INTERVAL TOO SMALL";
-        case status_code::interval_too_brief:
-            return "INTERVAL TOO BRIEF";
-        case status_code::bad_location_information:
-            return "BAD LOCATION INFORMATION";
-        case status_code::bad_alert_information:
-            return "BAD ALERT INFORMATION";
-        case status_code::use_identity_header:
-            return "USE IDENTITY HEADER";
-        case status_code::provide_referrer_identity:
-            return "PROVIDE REFERRER IDENTITY";
-        case status_code::flow_failed:
-            return "FLOW FAILED";
-        case status_code::anonymity_disallowed:
-            return "ANONYMITY DISALLOWED";
-        case status_code::bad_identity_info:
-            return "BAD IDENTITY INFO";
-        case status_code::unsupported_certificate:
-            return "UNSUPPORTED CERTIFICATE";
-        case status_code::invalid_identity_header:
-            return "INVALID IDENTITY HEADER";
-        case status_code::first_hop_lacks_outbound_support:
-            return "FIRST HOP LACKS OUTBOUND SUPPORT";
-        case status_code::max_breadth_exceeded:
-            return "MAX BREADTH EXCEEDED";
-        case status_code::bad_info_package:
-            return "BAD INFO PACKAGE";
-        case status_code::consent_needed:
-            return "CONSENT NEEDED";
-        case status_code::temporarily_unavailable:
-            return "TEMPORARILY UNAVAILABLE";
-        case status_code::call_transaction_does_not_exist:
-            return "CALL TRANSACTION DOES NOT EXIST";
-        case status_code::loop_detected:
-            return "LOOP DETECTED";
-        case status_code::too_many_hops:
-            return "TOO MANY HOPS";
-        case status_code::address_incomplete:
-            return "ADDRESS INCOMPLETE";
-        case status_code::ambiguous:
-            return "AMBIGUOUS";
-        case status_code::busy_here:
-            return "BUSY HERE";
-        case status_code::request_terminated:
-            return "REQUEST TERMINATED";
-        case status_code::not_acceptable_here:
-            return "NOT ACCEPTABLE HERE";
-        case status_code::bad_event:
-            return "BAD EVENT";
-        case status_code::request_pending:
-            return "REQUEST PENDING";
-        case status_code::undecipherable:
-            return "UNDECIPHERABLE";
-        case status_code::security_agreement_required:
-            return "SECURITY AGREEMENT REQUIRED";
-        case status_code::internal_server_error:
-            return "INTERNAL SERVER ERROR";
-        case status_code::not_implemented:
-            return "NOT IMPLEMENTED";
-        case status_code::bad_gateway:
-            return "BAD GATEWAY";
-        case status_code::service_unavailable:
-            return "SERVICE UNAVAILABLE";
-        case status_code::server_timeout:
-            return "SERVER TIMEOUT";
-        case status_code::version_not_supported:
-            return "VERSION NOT SUPPORTED";
-        case status_code::message_too_large:
-            return "MESSAGE TOO LARGE";
-        case status_code::push_notification_not_supported:
-            return "PUSH NOTIFICATION NOT SUPPORTED";
-        case status_code::precondition_failure:
-            return "PRECONDITION FAILURE";
-        case status_code::busy_everywhere:
-            return "BUSY EVERYWHERE";
-        case status_code::decline:
-            return "DECLINE";
-        case status_code::does_not_exist_anywhere:
-            return "DOES NOT EXIST ANYWHERE";
-        case status_code::not_acceptable_global:
-            return "NOT ACCEPTABLE GLOBAL";
-        case status_code::unwanted:
-            return "UNWANTED";
-        case status_code::rejected:
-            return "REJECTED";
-        default:
-            throw unknown_status_code();
+    const auto code_int = static_cast<uint16_t>(code);
+    if (code_int < min_status_code || code_int > max_status_code) {
+        throw unknown_status_code();
     }
+
+    const auto phrase = reason_phrases[code_int - min_status_code];
+    if (phrase == nullptr) {
+        throw unknown_status_code();
+    }
+
+    return phrase;
 }
 
 const char* transport_str(const transport transport) {
-    switch (transport) {
-        case transport::tcp:
-            return "TCP";
-        case transport::udp:
-            return "UDP";
-        default:
-            throw unknown_transport();
+    const auto str = transport_codec.encode(transport);
+    if (str.empty()) {
+        throw unknown_transport();
     }
+
+    // names are string literals, so they are null-terminated
+    return str.data();
 }
 
+param_value::param_value(std::string value, const bool quoted)
+    : value(std::move(value))
+    , quoted(quoted)
+{}
+
+param_value::param_value(const char* value)
+    : value(value)
+{}
+
 std::istream& operator>>(std::istream& is, method& method) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter);
 
-    const auto it = m_str_to_method.find(line);
-    if (it != m_str_to_method.end()) {
-        method = it->second;
+    const auto value = method_codec.decode(line);
+    if (value.has_value()) {
+        method = value.value();
     } else {
         throw unknown_method();
     }
@@ -308,47 +261,12 @@ std::istream& operator>>(std::istream& is, method& method) {
 }
 
 std::ostream& operator<<(std::ostream& os, const method method) {
-    switch (method) {
-        case method::invite:
-            os << "INVITE";
-            break;
-        case method::ack:
-            os << "ACK";
-            break;
-        case method::bye:
-            os << "BYE";
-            break;
-        case method::cancel:
-            os << "CANCEL";
-            break;
-        case method::update:
-            os << "UPDATE";
-            break;
-        case method::info:
-            os << "INFO";
-            break;
-        case method::subscribe:
-            os << "SUBSCRIBE";
-            break;
-        case method::notify:
-            os << "NOTIFY";
-            break;
-        case method::refer:
-            os << "REFER";
-            break;
-        case method::message:
-            os << "MESSAGE";
-            break;
-        case method::options:
-            os << "OPTIONS";
-            break;
-        case method::register_:
-            os << "REGISTER";
-            break;
-        default:
-            throw unknown_method();
+    const auto str = method_codec.encode(method);
+    if (str.empty()) {
+        throw unknown_method();
     }
 
+    os << str;
     return os;
 }
 
@@ -356,8 +274,12 @@ std::istream& operator>>(std::istream& is, status_code& code) {
     serialization::reader reader(is);
     const auto str = reader.read(3);
 
-    const auto int_code = std::stoi(str);
-    code = static_cast<status_code>(int_code);
+    const auto int_code = serialization::parse_number<uint16_t>(str);
+    if (str.size() != 3 || !int_code.has_value()) {
+        throw unknown_status_code();
+    }
+
+    code = static_cast<status_code>(int_code.value());
 
     return is;
 }
@@ -374,9 +296,9 @@ std::istream& operator>>(std::istream& is, version& version) {
 
     const auto line = reader.read_while(serialization::is_number_or_dot);
 
-    const auto it = m_str_to_version.find(line);
-    if (it != m_str_to_version.end()) {
-        version = it->second;
+    const auto value = version_codec.decode(line);
+    if (value.has_value()) {
+        version = value.value();
     } else {
         throw unknown_version();
     }
@@ -387,14 +309,12 @@ std::istream& operator>>(std::istream& is, version& version) {
 std::ostream& operator<<(std::ostream& os, const version version) {
     os << "SIP/";
 
-    switch (version) {
-        case version::version_2_0:
-            os << "2.0";
-            break;
-        default:
-            throw unknown_version();
+    const auto str = version_codec.encode(version);
+    if (str.empty()) {
+        throw unknown_version();
     }
 
+    os << str;
     return os;
 }
 
@@ -402,11 +322,11 @@ std::istream& operator>>(std::istream& is, transport& transport) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter);
 
-    const auto it = m_str_to_transport.find(line);
-    if (it != m_str_to_transport.end()) {
-        transport = it->second;
+    const auto value = transport_codec.decode(line);
+    if (value.has_value()) {
+        transport = value.value();
     } else {
-        throw unknown_method();
+        throw unknown_transport();
     }
 
     return is;
@@ -422,25 +342,23 @@ std::istream& operator>>(std::istream& is, auth_scheme& auth_scheme) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter);
 
-    const auto it = m_str_to_authscheme.find(line);
-    if (it != m_str_to_authscheme.end()) {
-        auth_scheme = it->second;
+    const auto value = auth_scheme_codec.decode(line);
+    if (value.has_value()) {
+        auth_scheme = value.value();
     } else {
-        throw unknown_method();
+        throw unknown_auth_scheme();
     }
 
     return is;
 }
 
 std::ostream& operator<<(std::ostream& os, const auth_scheme auth_scheme) {
-    switch (auth_scheme) {
-        case auth_scheme::digest:
-            os << "Digest";
-            break;
-        default:
-            throw unknown_auth_scheme();
+    const auto str = auth_scheme_codec.encode(auth_scheme);
+    if (str.empty()) {
+        throw unknown_auth_scheme();
     }
 
+    os << str;
     return os;
 }
 
@@ -448,29 +366,102 @@ std::istream& operator>>(std::istream& is, auth_algorithm& auth_algorithm) {
     serialization::reader reader(is);
     const auto line = reader.read_while(serialization::is_letter_number_or_dash);
 
-    const auto it = m_str_to_authalgorithm.find(line);
-    if (it != m_str_to_authalgorithm.end()) {
-        auth_algorithm = it->second;
+    const auto value = auth_algorithm_codec.decode(line);
+    if (value.has_value()) {
+        auth_algorithm = value.value();
     } else {
-        throw unknown_method();
+        throw unknown_auth_algorithm();
     }
 
     return is;
 }
 
 std::ostream& operator<<(std::ostream& os, const auth_algorithm auth_algorithm) {
-    switch (auth_algorithm) {
-        case auth_algorithm::aka:
-            os << "AKAv1-MD5";
-            break;
-        case auth_algorithm::md5:
-            os << "MD5";
-            break;
-        default:
-            throw unknown_auth_algorithm();
+    const auto str = auth_algorithm_codec.encode(auth_algorithm);
+    if (str.empty()) {
+        throw unknown_auth_algorithm();
     }
 
+    os << str;
     return os;
 }
 
+serialization::span_reader& operator>>(serialization::span_reader& reader, method& method) {
+    const auto str = reader.read_while<serialization::is_letter>();
+
+    const auto value = method_codec.decode(str);
+    if (value.has_value()) {
+        method = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, status_code& code) {
+    const auto int_code = serialization::parse_number<uint16_t>(reader.read(3));
+    if (!int_code.has_value()) {
+        reader.fail(serialization::read_error::unknown_value);
+        return reader;
+    }
+
+    code = static_cast<status_code>(int_code.value());
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, version& version) {
+    reader.eat("SIP/");
+    const auto str = reader.read_while<serialization::is_number_or_dot>();
+
+    const auto value = version_codec.decode(str);
+    if (value.has_value()) {
+        version = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, transport& transport) {
+    const auto str = reader.read_while<serialization::is_letter>();
+
+    const auto value = transport_codec.decode(str);
+    if (value.has_value()) {
+        transport = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, auth_scheme& auth_scheme) {
+    const auto str = reader.read_while<serialization::is_letter>();
+
+    const auto value = auth_scheme_codec.decode(str);
+    if (value.has_value()) {
+        auth_scheme = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
+serialization::span_reader& operator>>(serialization::span_reader& reader, auth_algorithm& auth_algorithm) {
+    const auto str = reader.read_while<serialization::is_letter_number_or_dash>();
+
+    const auto value = auth_algorithm_codec.decode(str);
+    if (value.has_value()) {
+        auth_algorithm = value.value();
+    } else {
+        reader.fail(serialization::read_error::unknown_value);
+    }
+
+    return reader;
+}
+
 }
@@ -1,14 +1,133 @@
 
+#include <algorithm>
+#include <array>
+#include <map>
 #include <unordered_map>
 
+#include "util/string_helper.h"
 #include "types_storage.h"
 
 namespace sippy::sip {
 
+static constexpr uint32_t hash_name(const std::string_view name) {
+    // fnv-1a over the lower case name
+    uint32_t hash = 2166136261u;
+    for (const auto ch : name) {
+        hash ^= static_cast<uint8_t>(util::to_lower(ch));
+        hash *= 16777619u;
+    }
+
+    return hash;
+}
+
+struct _name_hash {
+    using is_transparent = void;
+
+    size_t operator()(const std::string_view name) const {
+        return hash_name(name);
+    }
+};
+
+struct _name_equal {
+    using is_transparent = void;
+
+    bool operator()(const std::string_view lhs, const std::string_view rhs) const {
+        return util::equals_ignore_case(lhs, rhs);
+    }
+};
+
 namespace headers::storage {
 
-static std::unordered_map<std::string, std::shared_ptr<_base_header_def>>& _get_storage() {
-    static std::unordered_map<std::string, std::shared_ptr<_base_header_def>> _headers;
+_raw_value::_raw_value(const std::string_view value, std::shared_ptr<const void> buffer)
+    : m_value(value)
+    , m_buffer(std::move(buffer))
+{}
+
+std::string_view _raw_value::view() const {
+    return m_value;
+}
+
+// definitions of the built-in types, constant initialized so lookups never touch a refcount
+template<meta::_header_type T>
+static const _header_def<T> _known_def{};
+
+struct _known_name {
+    std::string_view name;
+    const _base_header_def* def;
+};
+
+// by id, like meta::_known_headers
+static constexpr auto _known_defs = std::to_array<const _base_header_def*>({
+#define SIPPY_KNOWN_HEADER_DEF(h_name, str_name, compact_name) &_known_def<h_name>,
+    SIPPY_KNOWN_HEADERS(SIPPY_KNOWN_HEADER_DEF)
+#undef SIPPY_KNOWN_HEADER_DEF
+});
+
+static constexpr size_t _known_compact_count = std::ranges::count_if(meta::_known_compact_headers, [](const std::string_view name) {
+    return !name.empty();
+});
+
+// names of the built-in headers, including compact forms
+static constexpr auto _known_names = [] {
+    std::array<_known_name, meta::_known_headers.size() + _known_compact_count> names{};
+    size_t index = 0;
+    for (size_t id = 0; id < meta::_known_headers.size(); id++) {
+        names[index++] = {meta::_known_headers[id], _known_defs[id]};
+        if (!meta::_known_compact_headers[id].empty()) {
+            names[index++] = {meta::_known_compact_headers[id], _known_defs[id]};
+        }
+    }
+
+    return names;
+}();
+
+static constexpr size_t _known_table_bits = 7;
+static constexpr size_t _known_table_size = 1 << _known_table_bits;
+
+static constexpr size_t known_slot(const uint32_t hash, const uint32_t seed) {
+    return static_cast<uint32_t>((hash ^ seed) * 0x9e3779b1u) >> (32 - _known_table_bits);
+}
+
+static constexpr bool is_perfect_seed(const uint32_t seed) {
+    std::array<bool, _known_table_size> used{};
+    for (const auto& known : _known_names) {
+        const auto slot = known_slot(hash_name(known.name), seed);
+        if (used[slot]) {
+            return false;
+        }
+        used[slot] = true;
+    }
+
+    return true;
+}
+
+static constexpr uint32_t find_perfect_seed() {
+    for (uint32_t seed = 0; seed < 1000; seed++) {
+        if (is_perfect_seed(seed)) {
+            return seed;
+        }
+    }
+
+    return UINT32_MAX;
+}
+
+static constexpr uint32_t _known_seed = find_perfect_seed();
+static_assert(_known_seed != UINT32_MAX, "no perfect hash seed for the known header names");
+
+// slot -> index in _known_names, -1 for empty slots
+static constexpr std::array<int8_t, _known_table_size> _known_slots = [] {
+    std::array<int8_t, _known_table_size> slots{};
+    slots.fill(-1);
+    for (size_t i = 0; i < _known_names.size(); i++) {
+        slots[known_slot(hash_name(_known_names[i].name), _known_seed)] = static_cast<int8_t>(i);
+    }
+
+    return slots;
+}();
+
+// headers registered at runtime, for types declared outside the library
+static std::unordered_map<std::string, std::shared_ptr<_base_header_def>, _name_hash, _name_equal>& _get_storage() {
+    static std::unordered_map<std::string, std::shared_ptr<_base_header_def>, _name_hash, _name_equal> _headers;
     return _headers;
 }
 
@@ -16,60 +135,54 @@ void _register_header_internal(const std::string& name, std::shared_ptr<_base_he
     _get_storage()[name] = std::move(ptr);
 }
 
-std::optional<std::shared_ptr<_base_header_def> > get_header(const std::string &name) {
+const _base_header_def* get_header(const std::string_view name) {
+    const auto index = _known_slots[known_slot(hash_name(name), _known_seed)];
+    if (index >= 0 && util::equals_ignore_case(_known_names[index].name, name)) {
+        return _known_names[index].def;
+    }
+
     const auto it = _get_storage().find(name);
     if (it != _get_storage().end()) {
-        return it->second;
+        return it->second.get();
     }
-    return std::nullopt;
+    return nullptr;
 }
 
 }
 
 namespace bodies::storage {
 
-static std::unordered_map<std::string, std::shared_ptr<_base_body_def>>& _get_storage() {
-    static std::unordered_map<std::string, std::shared_ptr<_base_body_def>> _headers;
-    return _headers;
+template<meta::_body_type T>
+static const _body_def<T> _known_def{};
+
+static constexpr std::array<const _base_body_def*, 2> _known_defs = {
+    &_known_def<test>,
+    &_known_def<sdp>,
+};
+
+static std::map<std::string, std::shared_ptr<_base_body_def>, std::less<>>& _get_storage() {
+    static std::map<std::string, std::shared_ptr<_base_body_def>, std::less<>> _bodies;
+    return _bodies;
 }
 
 void _register_body_internal(const std::string& name, std::shared_ptr<_base_body_def> ptr) {
     _get_storage()[name] = std::move(ptr);
 }
 
-std::optional<std::shared_ptr<_base_body_def>> get_body(const std::string &name) {
+const _base_body_def* get_body(const std::string_view name) {
+    for (const auto def : _known_defs) {
+        if (name == def->application_type()) {
+            return def;
+        }
+    }
+
     const auto it = _get_storage().find(name);
     if (it != _get_storage().end()) {
-        return it->second;
+        return it->second.get();
     }
-    return std::nullopt;
+    return nullptr;
 }
 
 }
 
-
-void __attribute__((constructor)) register_known_types() {
-    headers::register_header<headers::from>();
-    headers::register_header<headers::to>();
-    headers::register_header<headers::contact>();
-    headers::register_header<headers::cseq>();
-    headers::register_header<headers::call_id>();
-    headers::register_header<headers::via>();
-    headers::register_header<headers::content_length>();
-    headers::register_header<headers::content_type>();
-    headers::register_header<headers::max_forwards>();
-    headers::register_header<headers::expires>();
-    headers::register_header<headers::min_expires>();
-    headers::register_header<headers::record_route>();
-    headers::register_header<headers::route>();
-    headers::register_header<headers::subject>();
-    headers::register_header<headers::allow>();
-    headers::register_header<headers::server>();
-    headers::register_header<headers::authorization>();
-    headers::register_header<headers::www_authorization>();
-
-    bodies::register_body<bodies::test>();
-    bodies::register_body<bodies::sdp>();
-}
-
 }
@@ -9,13 +9,14 @@ namespace sippy::sip {
 
 namespace headers::storage {
 
-std::optional<std::shared_ptr<_base_header_def>> get_header(const std::string& name);
+// nullptr if the header is unknown
+const _base_header_def* get_header(std::string_view name);
 
 }
 
 namespace bodies::storage {
 
-std::optional<std::shared_ptr<_base_body_def>> get_body(const std::string& name);
+const _base_body_def* get_body(std::string_view name);
 
 }
 
@@ -17,6 +17,7 @@ public:
 
 writer::writer(std::ostream& os)
     : m_os(os)
+    , m_message()
     , m_request_line()
     , m_status_line()
     , m_headers()
@@ -30,8 +31,8 @@ void writer::attach(message_ptr msg) {
         throw invalid_message();
     }
 
-    const auto message = std::move(msg);
-    load(message);
+    m_message = std::move(msg);
+    load(m_message);
 }
 
 void writer::write() {
@@ -54,7 +55,7 @@ void writer::load(const message_ptr& msg) {
     m_request_line = std::move(msg->m_request_line);
     m_status_line = std::move(msg->m_status_line);
 
-    for (auto& holders: msg->m_headers | std::views::values) {
+    const auto take = [this](std::pmr::vector<headers::storage::_header_holder_ptr>& holders) {
         for (auto& holder : holders) {
             if ((holder->flags() & headers::flag_autogenerated) != 0) {
                 continue;
@@ -62,19 +63,29 @@ void writer::load(const message_ptr& msg) {
 
             m_headers.push_back(std::move(holder));
         }
+    };
+
+    for (auto& holders : msg->m_known_headers) {
+        take(holders);
+    }
+    for (auto& holders : msg->m_dynamic_headers | std::views::values) {
+        take(holders);
     }
 
     m_body = std::move(msg->m_body);
 }
 
 void writer::add_necessary_headers() {
-    auto content_length = std::make_unique<headers::storage::_header_holder<headers::content_length>>();
-    content_length->value.length = m_body_str.size();
+    using content_length_holder = headers::storage::_header_holder<headers::content_length>;
+    using content_type_holder = headers::storage::_header_holder<headers::content_type>;
+
+    auto content_length = _make_holder<content_length_holder, headers::storage::_base_header_holder>(m_message->_resource());
+    static_cast<content_length_holder&>(*content_length).mutable_value().length = m_body_str.size();
     m_headers.push_back(std::move(content_length));
 
     if (!m_body_type.empty()) {
-        auto content_type = std::make_unique<headers::storage::_header_holder<headers::content_type>>();
-        content_type->value.type = std::move(m_body_type);
+        auto content_type = _make_holder<content_type_holder, headers::storage::_base_header_holder>(m_message->_resource());
+        static_cast<content_type_holder&>(*content_type).mutable_value().type = std::move(m_body_type);
         m_headers.push_back(std::move(content_type));
     }
 }
@@ -125,7 +136,12 @@ void writer::write_headers() {
         }
 
         m_os << header->name() << ": ";
-        header->operator<<(m_os);
+        if (header->raw.has_value()) {
+            // never decoded, so it is still as it was received
+            m_os << header->raw->view();
+        } else {
+            header->operator<<(m_os);
+        }
         m_os << "\r\n";
     }
 }
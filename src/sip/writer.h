@@ -21,6 +21,8 @@ private:
     void compose_body();
 
     std::ostream& m_os;
+    // kept until written, the headers taken from it may live in its arena
+    message_ptr m_message;
     std::optional<request_line> m_request_line;
     std::optional<status_line> m_status_line;
     std::vector<headers::storage::_header_holder_ptr> m_headers;
@@ -6,7 +6,32 @@ namespace sippy::util {
 
 bool is_numeric_string(const std::string_view str) {
     for (const auto& ch : str) {
-        if (!std::isdigit(ch)) {
+        if (ch < '0' || ch > '9') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+std::string_view trim_whitespace(std::string_view str) {
+    while (!str.empty() && (str.front() == ' ' || str.front() == '\t')) {
+        str.remove_prefix(1);
+    }
+    while (!str.empty() && (str.back() == ' ' || str.back() == '\t')) {
+        str.remove_suffix(1);
+    }
+
+    return str;
+}
+
+bool equals_ignore_case(const std::string_view lhs, const std::string_view rhs) {
+    if (lhs.size() != rhs.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < lhs.size(); i++) {
+        if (to_lower(lhs[i]) != to_lower(rhs[i])) {
             return false;
         }
     }
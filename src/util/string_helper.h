@@ -4,6 +4,13 @@
 
 namespace sippy::util {
 
+// ascii only, header names and tokens are ascii and bytes above 0x7f are left as is
+constexpr char to_lower(const char ch) {
+    return (ch >= 'A' && ch <= 'Z') ? static_cast<char>(ch - 'A' + 'a') : ch;
+}
+
 bool is_numeric_string(std::string_view str);
+std::string_view trim_whitespace(std::string_view str);
+bool equals_ignore_case(std::string_view lhs, std::string_view rhs);
 
 }
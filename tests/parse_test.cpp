@@ -0,0 +1,387 @@
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <sip/header_index.h>
+#include <sip/message.h>
+#include <sip/responses.h>
+#include <sip/stream_parser.h>
+
+using namespace sippy;
+
+static int failures = 0;
+
+static void check(const bool condition, const std::string_view what) {
+    if (!condition) {
+        std::cerr << "failed: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::span<const uint8_t> as_span(const std::string_view str) {
+    return {reinterpret_cast<const uint8_t*>(str.data()), str.size()};
+}
+
+static constexpr std::string_view bad_content_length =
+    "OPTIONS sip:bob@biloxi.com SIP/2.0\r\n"
+    "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n"
+    "Call-ID: a84b4c76e66710\r\n"
+    "Content-Length: abc\r\n"
+    "\r\n";
+
+static void try_parse_bad_content_length(const std::string_view name, const sip::parse_options& options) {
+    try {
+        const auto result = sip::try_parse(as_span(bad_content_length), options);
+        check(!result.has_value(), name);
+        if (!result.has_value()) {
+            check(result.error().code == sip::parse_error_code::bad_number, name);
+        }
+    } catch (const std::exception&) {
+        check(false, name);
+    }
+}
+
+static constexpr std::string_view options_request =
+    "OPTIONS sip:bob@biloxi.com SIP/2.0\r\n"
+    "Call-ID: a84b4c76e66710\r\n"
+    "Content-Length: 0\r\n"
+    "\r\n";
+
+static constexpr std::string_view bad_request =
+    "OPTIONS sip:bob@biloxi.com SIP/2.0\r\n"
+    "CSeq: x OPTIONS\r\n"
+    "Content-Length: 0\r\n"
+    "\r\n";
+
+static void stream_keeps_framing_after_errors() {
+    std::string data;
+    data += options_request;
+    data += bad_request;
+    data += options_request;
+    data += options_request;
+
+    sip::stream_parser parser;
+    size_t messages = 0;
+    size_t errors = 0;
+    bool thrown = false;
+    try {
+        parser.feed(as_span(data), [&messages](sip::message_ptr&&) {
+            if (messages++ == 0) {
+                throw std::runtime_error("callback failed");
+            }
+        }, [&errors](const sip::parse_error&) {
+            errors++;
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+
+    check(thrown, "stream callback exception rethrown");
+    check(messages == 3, "stream delivers messages after a failure");
+    check(errors == 1, "stream reports bad message");
+    check(parser.pending() == 0, "stream leaves nothing buffered");
+}
+
+static void stream_frames_messages_split_across_reads() {
+    std::string data;
+    data +=
+        "MESSAGE sip:bob@biloxi.com SIP/2.0\r\n"
+        "Call-ID: a84b4c76e66710\r\n"
+        "Content-Type: application/test\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n"
+        "hello";
+    data += options_request;
+
+    sip::stream_parser parser;
+    size_t messages = 0;
+    size_t errors = 0;
+    bool pending_mid_message = false;
+    for (size_t i = 0; i < data.size(); i++) {
+        parser.feed(as_span(std::string_view(data).substr(i, 1)), [&messages](sip::message_ptr&&) {
+            messages++;
+        }, [&errors](const sip::parse_error&) {
+            errors++;
+        });
+
+        if (i == data.size() / 2) {
+            pending_mid_message = parser.pending() > 0;
+        }
+    }
+
+    check(messages == 2, "stream frames messages fed a byte at a time");
+    check(errors == 0, "stream split message is not an error");
+    check(pending_mid_message, "stream buffers a partial message");
+    check(parser.pending() == 0, "stream leaves nothing buffered after split messages");
+}
+
+static void parse_many_returns_framing_errors() {
+    std::string data;
+    data += options_request;
+    data += "OPTIONS sip:bob@biloxi.com SIP/2.0\r\nContent-Length: x\r\n\r\n";
+    data += options_request;
+
+    try {
+        const auto result = sip::parse_many(as_span(data));
+        check(result.messages.size() == 2, "parse_many stops at framing error");
+        check(result.messages.size() == 2 && result.messages[0].has_value(), "parse_many message before framing error");
+        check(result.messages.size() == 2 && !result.messages[1].has_value() &&
+            result.messages[1].error().code == sip::parse_error_code::bad_content_length, "parse_many framing error");
+        check(result.remaining.empty(), "parse_many drops unframed data");
+    } catch (const std::exception&) {
+        check(false, "parse_many throws");
+    }
+}
+
+static void copies_share_headers_until_changed() {
+    constexpr std::string_view request =
+        "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+        "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n"
+        "To: Bob <sip:bob@biloxi.com>\r\n"
+        "From: Alice <sip:alice@atlanta.com>;tag=1928301774\r\n"
+        "Call-ID: a84b4c76e66710\r\n"
+        "CSeq: 314159 INVITE\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+    const auto parsed = sip::parse(as_span(request));
+    const auto& original = *parsed;
+    const auto ringing = sip::create_response(sip::status_code::ringing, original, 60, 70);
+    auto response = sip::create_response(sip::status_code::ok, original, 60, 70);
+    const auto& copy = *response;
+
+    check(&copy.header<sip::headers::to>() == &ringing->header<sip::headers::to>(), "copied header is shared");
+
+    response->mutable_header<sip::headers::to>().tag = "a6c85cf";
+    check(&copy.header<sip::headers::to>() != &ringing->header<sip::headers::to>(), "changed header is un-shared");
+    check(!original.header<sip::headers::to>().tag.has_value(), "change does not reach the original");
+    check(!ringing->header<sip::headers::to>().tag.has_value(), "change does not reach other copies");
+    check(copy.header<sip::headers::to>().tag == "a6c85cf", "change is kept");
+}
+
+static void contact_params_round_trip() {
+    constexpr std::string_view contact =
+        "Contact: <sip:alice@pc33.atlanta.com>"
+        ";+sip.instance=\"<urn:uuid:00000000-0000-1000-8000-000a95a0e128>\";reg-id=1;ob;x=\r\n";
+    const auto request =
+        std::string("REGISTER sip:registrar.biloxi.com SIP/2.0\r\n") +
+        "Call-ID: 843817637684230@998sdasdh09\r\n" +
+        std::string(contact) +
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+    auto message = sip::parse(as_span(request));
+    const auto& params = message->header<sip::headers::contact>().tags;
+    const auto instance = params.find("+sip.instance");
+    check(instance != params.end() && instance->second.quoted, "quoted param is marked");
+    check(params.find("ob") != params.end() && !params.find("ob")->second.value.has_value(), "param without value");
+
+    std::stringstream out;
+    sip::write(out, std::move(message));
+    check(out.str().find(contact) != std::string::npos, "contact params are written back as read");
+}
+
+static void tag_round_trip() {
+    constexpr std::string_view from = "From: Alice <sip:alice@atlanta.com>;tag\r\n";
+    constexpr std::string_view to = "To: Bob <sip:bob@biloxi.com>;tag=\"q t\"\r\n";
+    const auto request =
+        std::string("OPTIONS sip:bob@biloxi.com SIP/2.0\r\n") +
+        std::string(from) +
+        std::string(to) +
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+    auto message = sip::parse(as_span(request));
+    check(message->header<sip::headers::from>().tag == "", "tag without value");
+    check(message->header<sip::headers::to>().tag == "\"q t\"", "quoted tag keeps its quotes");
+
+    std::stringstream out;
+    sip::write(out, std::move(message));
+    check(out.str().find(from) != std::string::npos, "tag without value is written back as read");
+    check(out.str().find(to) != std::string::npos, "quoted tag is written back as read");
+}
+
+static void header_index_finds_headers() {
+    constexpr std::string_view request =
+        "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+        "v: SIP/2.0/UDP h1;branch=z9hG4bK1, SIP/2.0/UDP h2;branch=z9hG4bK2\r\n"
+        "Via: SIP/2.0/TCP h3;branch=z9hG4bK3\r\n"
+        "Subject: first\r\n"
+        " second\r\n"
+        "Content-Length: 4\r\n"
+        "\r\n"
+        "body";
+
+    const auto index = sip::header_index::build(as_span(request));
+    check(index.has_value(), "header_index builds");
+    if (!index.has_value()) {
+        return;
+    }
+
+    check(index->is_request(), "header_index request");
+    check(index->start_line() == "INVITE sip:bob@biloxi.com SIP/2.0", "header_index start line");
+    check(index->line_count() == 4, "header_index line count");
+    check(request.substr(index->body_offset()) == "body", "header_index body offset");
+
+    check(index->header_count<sip::headers::via>() == 3, "header_index counts values across lines and compact names");
+    check(index->header<sip::headers::via>(1).host == "h2", "header_index value of a list");
+    check(index->header<sip::headers::via>(2).host == "h3", "header_index value of a later line");
+    check(index->header<sip::headers::subject>().value == "first second", "header_index folded value");
+    check(!index->has_header<sip::headers::cseq>(), "header_index missing header");
+}
+
+static void header_index_rejects_long_names() {
+    const auto request =
+        std::string("OPTIONS sip:bob@biloxi.com SIP/2.0\r\n") +
+        std::string(70000, 'X') + ": value\r\n"
+        "\r\n";
+
+    const auto index = sip::header_index::build(as_span(request));
+    check(!index.has_value(), "header_index long name");
+    if (!index.has_value()) {
+        check(index.error().code == sip::parse_error_code::header_line_too_long, "header_index long name error");
+    }
+}
+
+static void lazy_headers_decode_on_const_access() {
+    constexpr std::string_view via = "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n";
+    const auto request =
+        std::string("OPTIONS sip:bob@biloxi.com SIP/2.0\r\n") +
+        std::string(via) +
+        "Call-ID: a84b4c76e66710\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+    sip::parse_options options;
+    options.lazy_headers = true;
+    auto message = sip::parse(as_span(request), options);
+
+    const auto& decoded = *message;
+    check(decoded.header<sip::headers::via>().host == "pc33.atlanta.com", "lazy header decodes on const access");
+
+    const auto copy = sip::create_response(sip::status_code::ok, decoded, 60, 70);
+    check(copy->header<sip::headers::via>().host == "pc33.atlanta.com", "copy of a lazy header decodes");
+
+    std::stringstream out;
+    sip::write(out, std::move(message));
+    check(out.str().find(via) != std::string::npos, "read lazy header is written back as received");
+}
+
+static void lazy_header_errors_are_found_on_access() {
+    constexpr std::string_view request =
+        "OPTIONS sip:bob@biloxi.com SIP/2.0\r\n"
+        "CSeq: x OPTIONS\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+    sip::parse_options options;
+    options.lazy_headers = true;
+    const auto message = sip::try_parse(as_span(request), options);
+    check(message.has_value(), "lazy parse does not decode header values");
+    if (!message.has_value()) {
+        return;
+    }
+
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool thrown = false;
+        try {
+            (void) message.value()->header<sip::headers::cseq>();
+        } catch (const sip::parse_exception& e) {
+            thrown = e.error().code == sip::parse_error_code::bad_number;
+        }
+        check(thrown, "lazy header error is thrown on every access");
+    }
+}
+
+static void selected_headers_are_decoded_while_parsing() {
+    constexpr std::string_view cseq = "CSeq: not-a-number OPTIONS\r\n";
+    const auto request =
+        std::string("OPTIONS sip:bob@biloxi.com SIP/2.0\r\n"
+        "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n") +
+        std::string(cseq) +
+        "X-Unknown: dropped\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n";
+
+    const auto options = sip::parse_options::decode_only<sip::headers::via>();
+    check(options.should_decode(sip::headers::meta::_header_detail<sip::headers::via>::id()), "selected header is decoded");
+    check(!options.should_decode(sip::headers::meta::_header_detail<sip::headers::cseq>::id()), "other header is not decoded");
+    check(options.should_decode(sip::headers::meta::_header_detail<sip::headers::content_length>::id()), "content length is always decoded");
+
+    check(!sip::try_parse(as_span(request)).has_value(), "bad header fails eager parse");
+
+    auto message = sip::try_parse(as_span(request), options);
+    check(message.has_value(), "header not selected is not decoded while parsing");
+    if (!message.has_value()) {
+        return;
+    }
+    check(message.value()->header<sip::headers::via>().host == "pc33.atlanta.com", "selected header is read");
+
+    std::stringstream out;
+    sip::write(out, std::move(message.value()));
+    check(out.str().find(cseq) != std::string::npos, "header not selected is written back as received");
+    check(out.str().find("X-Unknown") == std::string::npos, "unknown header is dropped");
+}
+
+static void check_limit(const std::string_view name, const sip::parse_limits& limits, const sip::parse_error_code code) {
+    constexpr std::string_view request =
+        "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+        "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds, SIP/2.0/UDP h2;branch=z9hG4bK77\r\n"
+        "To: Bob <sip:bob@biloxi.com>\r\n"
+        "From: Alice <sip:alice@atlanta.com>;tag=1928301774\r\n"
+        "Call-ID: a84b4c76e66710\r\n"
+        "Contact: <sip:alice@pc33.atlanta.com>, <sip:alice@h2>\r\n"
+        "Content-Type: application/test\r\n"
+        "Content-Length: 4\r\n"
+        "\r\n"
+        "body";
+
+    sip::parse_options options;
+    options.limits = limits;
+    const auto result = sip::try_parse(as_span(request), options);
+    check(!result.has_value() && result.error().code == code, name);
+}
+
+static void parse_limits_are_enforced() {
+    check_limit("max message size", {.max_message_size = 64}, sip::parse_error_code::message_too_large);
+    check_limit("max headers", {.max_headers = 3}, sip::parse_error_code::too_many_headers);
+    check_limit("max header line", {.max_header_line = 40}, sip::parse_error_code::header_line_too_long);
+    check_limit("max via entries", {.max_via_entries = 1}, sip::parse_error_code::too_many_header_values);
+    check_limit("max contact entries", {.max_contact_entries = 1}, sip::parse_error_code::too_many_header_values);
+    check_limit("max body size", {.max_body_size = 2}, sip::parse_error_code::body_too_large);
+
+    const auto within = sip::try_parse(as_span(
+        "OPTIONS sip:bob@biloxi.com SIP/2.0\r\n"
+        "Call-ID: a84b4c76e66710\r\n"
+        "Content-Length: 0\r\n"
+        "\r\n"), {.limits = {.max_headers = 2, .max_header_line = 40}});
+    check(within.has_value(), "message within limits");
+}
+
+int main() {
+    parse_limits_are_enforced();
+    lazy_headers_decode_on_const_access();
+    lazy_header_errors_are_found_on_access();
+    selected_headers_are_decoded_while_parsing();
+    header_index_finds_headers();
+    header_index_rejects_long_names();
+    contact_params_round_trip();
+    tag_round_trip();
+    copies_share_headers_until_changed();
+    parse_many_returns_framing_errors();
+    stream_keeps_framing_after_errors();
+    stream_frames_messages_split_across_reads();
+
+    try_parse_bad_content_length("eager bad content length", {});
+
+    sip::parse_options lazy;
+    lazy.lazy_headers = true;
+    try_parse_bad_content_length("lazy bad content length", lazy);
+
+    try_parse_bad_content_length("selective bad content length", sip::parse_options::decode_only<sip::headers::via>());
+
+    return failures == 0 ? 0 : 1;
+}
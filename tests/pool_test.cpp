@@ -0,0 +1,116 @@
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string_view>
+
+#include <sip/message.h>
+#include <sip/message_pool.h>
+
+using namespace sippy;
+
+static size_t allocations = 0;
+
+void* operator new(const size_t size) {
+    allocations++;
+    if (void* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void* operator new(const size_t size, const std::align_val_t alignment) {
+    allocations++;
+    const auto align = static_cast<size_t>(alignment);
+    if (void* ptr = std::aligned_alloc(align, (size + align - 1) / align * align)) {
+        return ptr;
+    }
+
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+    std::free(ptr);
+}
+
+static int failures = 0;
+
+static void check(const bool condition, const std::string_view what) {
+    if (!condition) {
+        std::cerr << "failed: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::span<const uint8_t> as_span(const std::string_view str) {
+    return {reinterpret_cast<const uint8_t*>(str.data()), str.size()};
+}
+
+static constexpr std::string_view request =
+    "INVITE sip:bob@biloxi.com SIP/2.0\r\n"
+    "Via: SIP/2.0/UDP pc33.atlanta.com;branch=z9hG4bK776asdhds\r\n"
+    "Via: SIP/2.0/UDP bigbox3.site3.atlanta.com;branch=z9hG4bK77ef4c2312983.1\r\n"
+    "Max-Forwards: 70\r\n"
+    "To: Bob <sip:bob@biloxi.com>\r\n"
+    "From: Alice <sip:alice@atlanta.com>;tag=1928301774\r\n"
+    "Call-ID: a84b4c76e66710@pc33.atlanta.com\r\n"
+    "CSeq: 314159 INVITE\r\n"
+    "Contact: <sip:alice@pc33.atlanta.com>\r\n"
+    "X-Custom: whatever\r\n"
+    "Content-Length: 0\r\n"
+    "\r\n";
+
+static size_t count_parse(const sip::parse_options& options) {
+    const auto before = allocations;
+    {
+        const auto message = sip::parse(as_span(request), options);
+    }
+    return allocations - before;
+}
+
+// a recycled message keeps itself, its header lists and the entries of its unknown headers.
+// the header holders and the strings in their values are still allocated on every parse.
+static void recycled_messages_allocate_less() {
+    const auto unpooled = count_parse({});
+
+    sip::message_pool pool;
+    sip::parse_options options;
+    options.pool = &pool;
+
+    count_parse(options);
+    const auto recycled = count_parse(options);
+
+    check(recycled < unpooled, "recycled message allocates less");
+    for (int i = 0; i < 8; i++) {
+        check(count_parse(options) == recycled, "recycled message allocates the same every time");
+    }
+    check(pool.size() == 1, "message goes back to the pool");
+}
+
+// raw headers borrow from one copy of the buffer, their values are only allocated once decoded
+static void lazy_parse_allocates_less() {
+    sip::parse_options lazy;
+    lazy.lazy_headers = true;
+
+    check(count_parse(lazy) < count_parse({}), "lazy parse allocates less");
+}
+
+int main() {
+    recycled_messages_allocate_less();
+    lazy_parse_allocates_less();
+
+    return failures == 0 ? 0 : 1;
+}
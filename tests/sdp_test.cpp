@@ -0,0 +1,70 @@
+
+#include <iostream>
+#include <sstream>
+#include <string_view>
+
+#include <sdp/message.h>
+
+using namespace sippy;
+
+static int failures = 0;
+
+static void check(const bool condition, const std::string_view what) {
+    if (!condition) {
+        std::cerr << "failed: " << what << std::endl;
+        failures++;
+    }
+}
+
+static std::span<const uint8_t> as_span(const std::string_view str) {
+    return {reinterpret_cast<const uint8_t*>(str.data()), str.size()};
+}
+
+static void round_trip(const std::string_view name, const std::string_view body) {
+    const auto message = sdp::try_parse(as_span(body));
+    check(message.has_value(), name);
+    if (!message.has_value()) {
+        return;
+    }
+
+    std::stringstream out;
+    sdp::write(out, message.value());
+    check(out.str() == body, name);
+    if (out.str() != body) {
+        std::cerr << out.str() << std::endl;
+    }
+}
+
+int main() {
+    round_trip("minimal sdp",
+        "v=0\r\n"
+        "o=alice 2890844526 2890844526 IN IP4 atlanta.com\r\n"
+        "s=-\r\n"
+        "t=0 0\r\n");
+
+    round_trip("sdp with attributes",
+        "v=0\r\n"
+        "o=alice 2890844526 2890844526 IN IP4 atlanta.com\r\n"
+        "s=Session SDP\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "a=tool:foo 1.0\r\n"
+        "m=audio 49170 RTP/AVP 0 97\r\n"
+        "a=ptime:20\r\n"
+        "a=rtpmap:0 PCMU/8000\r\n"
+        "a=rtpmap:97 opus/48000/2\r\n");
+
+    round_trip("sdp with fmtp",
+        "v=0\r\n"
+        "o=alice 2890844526 2890844526 IN IP4 atlanta.com\r\n"
+        "s=-\r\n"
+        "c=IN IP4 10.0.0.1\r\n"
+        "t=0 0\r\n"
+        "m=audio 49170 RTP/AVP 111 101\r\n"
+        "a=fmtp:111 minptime=10;useinbandfec=1\r\n"
+        "a=fmtp:101 0-15\r\n"
+        "a=rtpmap:111 opus/48000/2\r\n"
+        "a=rtpmap:101 telephone-event/8000\r\n");
+
+    return failures == 0 ? 0 : 1;
+}